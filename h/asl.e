@@ -1,8 +1,19 @@
 #include "asl.h"
 
 extern int insertBlocked(int *semAdd, proc_t *p);
+extern int insertBlockedN(int *semAdd, proc_t *p, int units);
+extern int insertBlockedAny(int *semAdd, proc_t *p, int units, int any);
 extern proc_t *removeBlocked(int *semAdd);
+extern int removeBlockedAll(int *semAdd, proc_link *tp);
+extern int releaseBlocked(int *semAdd, proc_link *tp);
 extern proc_t *outBlocked(proc_t *p);
+extern proc_t *outBlockedRelease(proc_t *p, proc_link *tp);
+extern proc_t *outBlockedAny(proc_t *p, proc_link *tp);
 extern proc_t *headBlocked(int *semAddr);
+extern int countBlocked(int *semAddr);
 extern void initSemd();
+extern int extendSemd(semd_t *entries, int n);
 extern int headASL();
+extern semd_t *orderedASL();
+extern int setSemaphorePolicy(int *semAdd, int policy);
+extern int requeueBlocked(int *semAdd, proc_t *p);
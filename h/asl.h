@@ -8,6 +8,10 @@ typedef struct semd_t {
     int* s_semAdd;				/* pointer to the semaphore proper */
     proc_link s_link;			/* pointer/index to the tail of the queue of
                                    processes blocked on this semaphore */
+    int s_units;				/* units the blocked processes are waiting for in total */
+    int s_count;				/* processes blocked on this semaphore */
+    int s_any;					/* blocked processes that are in a wait-any */
+    int s_policy;				/* SEMFIFO or SEMPRIORITY, the order waiters are queued in */
 } semd_t;
 
 #endif
@@ -81,5 +81,76 @@
 #define MAX(A,B)	((A) < (B) ? B : A)
 #define	EVEN(A)		(((unsigned)A & 01) == 0)
 
-#define MAXPROC         20
-#define SEMMAX          10
+/* table sizes, each may be overridden at build time (e.g. -DMAXPROC=1024) */
+#ifndef MAXPROC
+#define MAXPROC         20	/* entries in the static process table */
+#endif
+#ifndef MAXSEMD
+#define MAXSEMD         MAXPROC	/* entries in the static semaphore descriptor table */
+#endif
+#ifndef EXTRAPROC
+#define EXTRAPROC       0	/* process entries carved at boot from memory below MEMSTART */
+#endif
+#define SEMMAX          10	/* maximum number of queues a process can be on at once */
+#ifndef MAXLINKS
+#define MAXLINKS        (2 * (MAXPROC + EXTRAPROC))	/* queue link nodes shared by all processes, most are on one or two queues */
+#endif
+/* link nodes that may hold processes on semaphore queues at once. The rest are kept so every process
+   can still be on a process queue (the RQ or a ready queue), a P that finds none free gets ENOSEMD */
+#define SEMLINKS        (MAXLINKS - (MAXPROC + EXTRAPROC))
+#ifndef EXTRASEMD
+/* semaphore descriptors carved at boot from memory below MEMSTART. None by default, a P that finds no free
+   descriptor gets ENOSEMD. Build with -DSEMDWORSTCASE to carve enough for every active semaphore to have one
+   (each holds at least one of the SEMLINKS link nodes) */
+#ifdef SEMDWORSTCASE
+#define EXTRASEMD       (SEMLINKS > MAXSEMD ? SEMLINKS - MAXSEMD : 0)
+#else
+#define EXTRASEMD       0
+#endif
+#endif
+#ifndef SEMPOLICIES
+#define SEMPOLICIES     16	/* semaphores that can have a waiting order other than FIFO at once */
+#endif
+
+#ifndef MAXMUTEX
+#define MAXMUTEX        8	/* mutexes (see semop) that can be held at once */
+#endif
+#ifndef SEMWATCHES
+#define SEMWATCHES      16	/* semaphores whose contention statistics (see SEMWATCH) can be kept at once */
+#endif
+
+/* scheduling (see schedule()) */
+#ifndef QUANTUM
+#define QUANTUM         5000	/* time slice of a process in microseconds, until it sets its own with SETQUANTUM */
+#endif
+#ifndef MLFQLEVELS
+#define MLFQLEVELS      3	/* ready queues, level 0 is served first */
+#endif
+#ifndef MLFQBOOST
+#define MLFQBOOST       100000	/* microseconds between moves of every ready process back to level 0 */
+#endif
+#define SCHEDMLFQ       0	/* policy: multilevel feedback queue */
+#define SCHEDSTRIDE     1	/* policy: stride scheduling, CPU time in proportion to p_tickets */
+#ifndef SCHEDPOLICY
+#define SCHEDPOLICY     SCHEDMLFQ	/* policy at boot, until changed with SETSCHED */
+#endif
+#ifndef TICKETS
+#define TICKETS         100	/* stride tickets of a process, until it sets its own with SETTICKETS */
+#endif
+#define STRIDE1         100	/* a process's stride pass advances by STRIDE1 / p_tickets per microsecond on the CPU */
+
+/* SYS4 functions, selected by D2 (any other value halts the nucleus) */
+#define SETPRIORITY     1	/* D4: new p_priority of the calling process */
+#define SEMPOLICY       2	/* D3: semaphore address, D4: SEMFIFO or SEMPRIORITY */
+#define SEMWATCH        3	/* D3: semaphore address, start keeping its statistics from zero */
+#define SEMSTATS        4	/* D3: semaphore address, D4: semstat to copy its statistics into */
+#define SETQUANTUM      5	/* D4: new time slice (microseconds) of the calling process, D3: TRUE to set it for its descendants too */
+#define SETSCHED        6	/* D4: SCHEDMLFQ or SCHEDSTRIDE, the scheduling policy of the nucleus */
+#define SETTICKETS      7	/* D4: new stride tickets of the calling process */
+
+/* D2 of a SYS3, SYS7 or SYS8 that had to block but found no free semaphore descriptor or link node (it does not block) */
+#define ENOSEMD         (-2)
+
+/* order in which processes wait on a semaphore */
+#define SEMFIFO         0	/* arrival order */
+#define SEMPRIORITY     1	/* highest p_priority first, arrival order among equals */
@@ -1,5 +1,9 @@
 extern void intdeadlock();
 extern void intschedule();
+extern void intsettimer();
+extern void intcheckslice();
 extern void intinit();
 extern void waitforpclock();
 extern void waitforio();
+extern void settimedwait();
+extern void canceltimedwait();
@@ -1,9 +1,17 @@
 #include "procq.h"
 
-extern void insertProc(proc_link* tp, proc_t* p);
+extern int insertProc(proc_link* tp, proc_t* p);
+extern int insertProcPriority(proc_link* tp, proc_t* p);
+extern int requeueProcPriority(proc_link* tp, proc_t* p);
 extern proc_t* removeProc(proc_link* tp);
 extern proc_t* outProc(proc_link* tp, proc_t* p);
+extern void unlinkProc(proc_link* tp, proc_t* p, int idx);
+extern int spliceProc(proc_link* from, proc_link* to);
 extern proc_t* allocProc();
+extern proc_t* allocProcN(int n);
 extern void freeProc(proc_t* p);
+extern void freeProcList(proc_t* p);
 extern void initProc();
+extern void extendProc(proc_t* entries, proc_cold* cold, int n);
 extern proc_t* headQueue(proc_link tp);
+extern proc_t* nextProc(proc_link* tp, proc_t* p);
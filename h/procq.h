@@ -1,24 +1,34 @@
 #ifndef PROCQ_H
 #define PROCQ_H
 
-/* link descriptor type */
+/* queue tail pointer type */
 typedef struct proc_link {
-	int index;					/* index of the p_link/queue where the next proc_t is */
-	struct proc_t* next;		/* next proc_t in particular queue */
+	int index;					/* linkPool index of the tail's link node */
+	struct proc_t* next;		/* proc_t at the tail of the queue */
 } proc_link;
 
-/* process table entry type */
-typedef struct proc_t {
-	proc_link p_link[SEMMAX];	/* pointers to next entries on queues */
-	state_t p_s;				/* processor state of the process */
-	int qcount;					/* number of queues containing this entry */
-	int* semvec[SEMMAX];		/* vector of active semaphores for this entry */
+/* linkPool index, kept in a short while the pool is small enough */
+#if MAXLINKS < 32768
+typedef short linkidx_t;
+#else
+typedef int linkidx_t;
+#endif
 
-	/*
-		other entries defined by me
-	*/
-	long last_start_time;			/* last time the CPU start executing this process */
-	long total_processor_time;		/* amount of processor time used by this process */
+/* queue link node type, taken from linkPool only while its process is on the queue */
+typedef struct link_t {
+	struct proc_t* owner;		/* proc_t this node holds on the queue */
+	struct proc_link* tp;		/* tail pointer of the queue this node belongs to (a descriptor's s_link on a semaphore queue) */
+	int units;					/* semaphore units the owner waits for on this queue, 0 if it is not a semaphore's */
+	linkidx_t next;				/* linkPool index of the next node in the queue */
+	linkidx_t prev;				/* linkPool index of the previous node in the queue */
+	linkidx_t sibling;			/* linkPool index of the owner's next node, or ENULL */
+	short any;					/* vpop index of the wait-any P that put the owner here, or ENULL */
+} link_t;
+
+/* cold part of a process table entry: only touched on context switches, trap pass-up,
+   and process creation and termination */
+typedef struct proc_cold {
+	state_t p_s;				/* processor state of the process */
 
 	state_t* prog_trap_old_state;   /* The area into which the processor state (the old state) is to be stored when a trap
 								       occurs while running this process. The address of this area will be in D3 */
@@ -35,6 +45,38 @@ typedef struct proc_t {
 	struct proc_t* sibling_proc;
 	struct proc_t* children_proc;
 
+	int base_priority;			/* p_priority as set by SETPRIORITY, before any inherited from mutex waiters */
+	int base_tickets;			/* p_tickets as set by SETTICKETS, before any inherited from mutex waiters */
+	int base_level;				/* p_level before a mutex waiter's priority moved it to level 0, or ENULL */
+	int* waiting_mutex;			/* word of the mutex (see semop) this process is blocked on, or ENULL */
+	int* wait_sem;				/* watched semaphore (see SEMWATCH) whose statistics get this process's current wait, or ENULL */
+	long wait_start;			/* time of day that wait began */
+
+	long wait_deadline;			/* time of day a timed P gives up at, 0 when not in a timed P */
+	struct proc_t* timed_next;	/* next process in a timed P, in deadline order (int.c) */
+} proc_cold;
+
+/* process table entry type, only the fields the queue operations and the scheduler touch */
+typedef struct proc_t {
+	int p_link;					/* linkPool index of the first of this entry's link nodes, or ENULL */
+	struct proc_t* p_next;		/* next entry on the procFree list (or on a list of entries being freed) */
+	int qcount;					/* number of queues containing this entry */
+	int p_priority;				/* higher is more urgent, orders the waiters of SEMPRIORITY semaphores */
+	int p_level;				/* MLFQ level, 0 (the top) to MLFQLEVELS-1, see schedule() */
+	long p_quantum;				/* time slice in microseconds, QUANTUM unless set with SETQUANTUM */
+	int p_tickets;				/* share of the CPU under SCHEDSTRIDE, TICKETS unless set with SETTICKETS */
+	long p_pass;				/* stride pass, the process with the lowest one runs next under SCHEDSTRIDE */
+
+	/*
+		other entries defined by me
+	*/
+	long last_start_time;			/* last time the CPU start executing this process */
+	long total_processor_time;		/* amount of processor time used by this process */
+
+	proc_cold* p_cold;				/* the rest of the entry, in procColdTable or carved with the entry */
+#ifdef COLDINLINE
+	proc_cold p_coldarea;			/* benchmark builds only: cold part kept inline, as before the split */
+#endif
 } proc_t;
 
 #endif
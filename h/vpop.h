@@ -1,10 +1,38 @@
 
+/* op is a count of units: -n is a P of n units and +n a V of n units, with n below PANY */
 #define LOCK -1
 #define UNLOCK 1
+#define VALL 0x40000000		/* V for every process blocked on the semaphore (broadcast) */
+#define MLOCK (VALL + 1)	/* take the mutex whose word (1 when free) is at sem */
+#define MUNLOCK (VALL + 2)	/* release it, handing it to its most urgent waiter */
+
+/* flags carried above the unit count of a P, see semop */
+#define PANY 0x08000000		/* wait-any: the first of these P's to get its units fires, index in D3 */
+#define PTRY 0x10000000		/* fail with -1 in D2 instead of blocking */
+#define PTIMED 0x20000000	/* block for at most the microseconds given in D2, -1 in D2 on a timeout */
+#define PUNITS (PANY - 1)	/* mask of the unit count */
+#define ANYMAX 0x7FFF		/* highest vpop index an any-P can have, past it the any-P is refused with -1 */
+#define TRYP(n) (-(PTRY | (n)))
+#define TIMEDP(n) (-(PTIMED | (n)))
+#define ANYP(n) (-(PANY | (n)))
+#define TRYLOCK TRYP(1)
+#define TIMEDLOCK TIMEDP(1)
+#define ANYLOCK ANYP(1)
 
 typedef struct vpop {
   int op;
   int *sem;
 } vpop; 
 
+/* contention statistics of a semaphore since its SEMWATCH, copied out by SEMSTATS (times in microseconds) */
+typedef struct semstat {
+  int *sem;
+  int ps;			/* P's applied to it by semop (MLOCK included) or by SYS7/SYS8, not refused or skipped ones */
+  int vs;			/* V's applied to it (V-all and MUNLOCK included) or by the interrupt handlers */
+  int blocked;		/* P's that blocked */
+  int peak;			/* most processes blocked on it at once */
+  long wait_total;	/* time blocked on it, summed over the waits that have ended */
+  long wait_max;	/* longest of those waits */
+} semstat;
+
 
@@ -56,7 +56,8 @@
 */
 
 #define TOTAL_DEVICES 15
-#define QUANTUM 5000;
+#define PSEUDOTICK 100000    // Microseconds between V's of the pseudo-clock semaphore
+#define NOEVENT 0x7fffffff   // Interval Timer value when no clock event is due (about 35 minutes)
 
 typedef struct {
     int status;
@@ -69,12 +70,26 @@ completion_stat deviceCompletionStats[TOTAL_DEVICES];
 devreg_t* deviceRegisters[TOTAL_DEVICES];
 
 /* Global Variables */
-int PSEUDO_CLOCK = 0;               // Clock to track total time in milliseconds CPU has been active
 int PSEUDO_CLOCK_SEMAPHORE = 0;     // No free resources
+long nextPseudoTick = 0;            // Time of day of the next pseudo-clock tick
+long nextBoost = 0;                 // Time of day of the next MLFQ boost (see mlfqboost() in main.c)
+long sliceEnd = 0;                  // Time of day the time slice of the running process ends
+int sliceArmed = FALSE;             // TRUE if the Interval Timer was last set with the end of that slice in mind
+proc_t* timedWaiters = (proc_t*)ENULL;  // Processes blocked in a timed P, soonest deadline first
 
 extern int MEMSTART;
 extern proc_link readyQueue;
 extern void schedule();
+extern void mlfqboost();
+extern int othersready();
+extern int schedPolicy;
+extern void updateTotalTimeOnProcessor(proc_t* process);
+extern int semWatchCount;
+extern void semstatop(int* semAddr, int isP);
+extern int semstatblock(int* semAddr);
+extern void semstatwait(proc_t* process, int* semAddr);
+extern proc_link* semstatqueue(proc_link* released);
+extern void semstatrelease(proc_link* released);
 
 /* Interrupt Area States */
 state_t* TERM_INTERRUPT_OLD_STATE;
@@ -87,6 +102,11 @@ state_t* CLOCK_INTERRUPT_OLD_STATE;
 void waitforpclock();
 void waitforio();
 
+/* Timed P deadlines */
+void settimedwait(proc_t*, long);
+void canceltimedwait(proc_t*);
+void static expiretimedwaits();
+
 /* Misc routines */
 void myprint(char*);
 
@@ -96,6 +116,12 @@ void static intprinterhandler();
 void static intdiskhandler();
 void static intfloppyhandler();
 void static intclockhandler();
+void static intresume(proc_t*, state_t*);
+
+/* Interval Timer */
+void intsettimer(proc_t*);
+void intcheckslice();
+int static pseudoclockadvance(long);
 
 
 /*
@@ -111,13 +137,73 @@ void static sleep()
 
 
 /*
-    This functions simply loads the timeslice into the Interval Timer.
-    Note that when we load the timeslice, the interrupt is only fired once after the time interval passes.
+    This function is called as the process (ENULL when the CPU is about to idle) is dispatched: its time slice
+    starts now, and the Interval Timer is set for the next clock event.
+*/
+void intschedule(proc_t* process)
+{
+    if (process != (proc_t*)ENULL) {
+        STCK(&sliceEnd);
+        sliceEnd += process->p_quantum;
+    }
+    intsettimer(process);
+}
+
+
+/*
+    This function loads the Interval Timer with the time left until the next event intclockhandler() has to deal with,
+    so no clock interrupt happens for nothing. The events are the next pseudo-clock tick if a process waits for it, the
+    first timed P deadline, and the end of the time slice of the running process if another process is ready to take
+    over. With none of them the timer is loaded with NOEVENT.
+    Note that when we load the timer, the interrupt is only fired once after the time interval passes.
+*/
+void intsettimer(proc_t* running)
+{
+    long currentTime;
+    STCK(&currentTime);
+    long interval = NOEVENT;
+
+    if (headBlocked(&PSEUDO_CLOCK_SEMAPHORE) != (proc_t*)ENULL) {
+        interval = MIN(interval, nextPseudoTick - currentTime);
+    }
+    if (timedWaiters != (proc_t*)ENULL) {
+        interval = MIN(interval, timedWaiters->p_cold->wait_deadline - currentTime);
+    }
+    sliceArmed = (running != (proc_t*)ENULL && othersready());
+    if (sliceArmed) {
+        interval = MIN(interval, sliceEnd - currentTime);
+    }
+
+    // An event that is already due gets its interrupt straight away
+    interval = MAX(interval, 1);
+    LDIT(&interval);
+}
+
+
+/*
+    This function is called before the running process is resumed after a V, a new process or an interrupt may have
+    made another process ready. If the Interval Timer was set without the end of its time slice in mind, because no
+    other process was ready, it is set again.
+*/
+void intcheckslice()
+{
+    if (!sliceArmed && othersready()) {
+        intsettimer(headQueue(readyQueue));
+    }
+}
+
+
+/*
+    Move nextPseudoTick past currentTime, over the ticks that went by (with no interrupt if nobody waited for them).
+    Return TRUE if at least one did.
 */
-void intschedule()
+int static pseudoclockadvance(long currentTime)
 {
-    long INTERVAL_SLICE = QUANTUM;
-    LDIT(&INTERVAL_SLICE);
+    if (currentTime < nextPseudoTick) {
+        return FALSE;
+    }
+    nextPseudoTick += ((currentTime - nextPseudoTick) / PSEUDOTICK + 1) * PSEUDOTICK;
+    return TRUE;
 }
 
 
@@ -126,8 +212,11 @@ void intschedule()
     the address of a semaphore (instead of a state_t), and the operation. 
     This function should use the ASL and should call insertBlocked and removeBlocked
     Note that in our implementation, a device can ONLY block 1 process at any given moment
+    Return TRUE if a LOCK had to block but no semaphore descriptor was free (the semaphore is left
+    as it was and the process keeps running, see ENOSEMD), FALSE otherwise.
+    A LOCK that blocks saves the caller's SYS old state into its p_s, the only copy made of it.
 */
-void static intsemop(int* semAddr, int op)
+int static intsemop(int* semAddr, int op)
 {
     // This function is invoked by 
     // - wait_for_io (to BLOCK the running process for I/O operations)
@@ -143,11 +232,25 @@ void static intsemop(int* semAddr, int op)
     if (op == LOCK) {
         // Ensure the semaphore has no more free resources before blocking the process
         if (prevSemVal <= 0) {
-            // Remove the interrupted process from the RQ
-            proc_t* process = removeProc(&readyQueue);
-
             // Semaphore has become negative, meaning it should block the process that invoked the wait_for_io or wait_for_plock routines
-            insertBlocked(semAddr, process);
+            // It is only taken off the RQ once it is on the semaphore queue, so running out of descriptors cannot lose it
+            proc_t* process = headQueue(readyQueue);
+            if (insertBlocked(semAddr, process)) {
+                *semAddr = prevSemVal;
+                return TRUE;
+            }
+            removeProc(&readyQueue);
+
+            // Only now that it leaves the CPU is its state (the SYS7/SYS8 old state) saved, to be reloaded later
+            process->p_cold->p_s = *(state_t*)0x930;
+
+            // The LOCK has taken effect, so it counts (with the block) towards the statistics of a watched semaphore
+            int* watchedSem = (int*)ENULL;
+            if (semWatchCount > 0) {
+                semstatop(semAddr, TRUE);
+                watchedSem = semstatblock(semAddr) ? semAddr : (int*)ENULL;
+            }
+            semstatwait(process, watchedSem);
 
             // This process is no longer running, prime interval timer and prepare to run next process on RQ
             schedule();
@@ -157,14 +260,94 @@ void static intsemop(int* semAddr, int op)
     else if (op == UNLOCK) {
         if (prevSemVal < 0) {
             // Remove the process at the head of the corresponding device or pseudo-clock Semaphore Queue
+            proc_link released;
+            proc_link* releaseTo = semstatqueue(&released);
             proc_t* process = removeBlocked(semAddr);
 
             // If the process is no longer blocked on any other semaphores, then add it back to the RQ
             if (process != (proc_t*)ENULL && process->qcount == 0) {
-                insertProc(&readyQueue, process);
+                insertProc(releaseTo, process);
             }
+            semstatrelease(&released);
+        }
+    }
+
+    // A LOCK that did not block, or an UNLOCK
+    if (semWatchCount > 0) {
+        semstatop(semAddr, op == LOCK);
+    }
+    return FALSE;
+}
+
+
+/*
+    This function arms the deadline of a process that semop has just blocked in a timed P. The process
+    is kept on the timedWaiters list, in deadline order, until it runs again or the deadline passes.
+*/
+void settimedwait(proc_t* process, long timeout)
+{
+    long currentTime;
+    STCK(&currentTime);
+    long deadline = currentTime + timeout;
+
+    // Insert behind every waiter whose deadline is not later, so equal deadlines expire in FIFO order
+    proc_t** entry = &timedWaiters;
+    while (*entry != (proc_t*)ENULL && (*entry)->p_cold->wait_deadline <= deadline) {
+        entry = &(*entry)->p_cold->timed_next;
+    }
+
+    process->p_cold->wait_deadline = deadline;
+    process->p_cold->timed_next = *entry;
+    *entry = process;
+}
+
+
+/*
+    This function drops the deadline of a process that got its units before it expired (schedule() calls it
+    when the process is loaded again) or that is being terminated.
+*/
+void canceltimedwait(proc_t* process)
+{
+    proc_t** entry = &timedWaiters;
+    while (*entry != (proc_t*)ENULL && *entry != process) {
+        entry = &(*entry)->p_cold->timed_next;
+    }
+
+    if (*entry == process) {
+        *entry = process->p_cold->timed_next;
+    }
+    process->p_cold->wait_deadline = 0;
+    process->p_cold->timed_next = (proc_t*)ENULL;
+}
+
+
+/*
+    This function is called on every clock interrupt while a timed P is pending. Every process whose
+    deadline has passed and is still blocked is taken off all its semaphore queues, the units it was
+    waiting for go back, and it is put back on the RQ with -1 in D2.
+*/
+void static expiretimedwaits()
+{
+    long currentTime;
+    STCK(&currentTime);
+    proc_link released;
+    proc_link* releaseTo = semstatqueue(&released);
+
+    while (timedWaiters != (proc_t*)ENULL && timedWaiters->p_cold->wait_deadline <= currentTime) {
+        proc_t* process = timedWaiters;
+        timedWaiters = process->p_cold->timed_next;
+        process->p_cold->wait_deadline = 0;
+        process->p_cold->timed_next = (proc_t*)ENULL;
+
+        // A process released by a V since is already on the RQ and keeps its 0 in D2
+        if (outBlockedRelease(process, releaseTo) != (proc_t*)ENULL) {
+            process->p_cold->p_s.s_r[2] = -1;
+            insertProc(releaseTo, process);
         }
     }
+
+    // Their waits still count toward the statistics of the semaphore they blocked on
+    semstatrelease(&released);
 }
 
 
@@ -173,17 +356,20 @@ void static intsemop(int* semAddr, int op)
 */
 void waitforpclock()
 {
-    // Grab the process requesting to block itself on the pseudoclock
-    proc_t* process = headQueue(readyQueue);
-
-    // Grab the interrupted process's state 
+    // Grab the interrupted process's state (intsemop saves it once the process is blocked)
     state_t* SYS_TRAP_OLD_STATE = (state_t*)0x930;
 
-    // Update the process's current processor state as it will be blocked and its state will need to be reloaded later
-    process->p_s = *SYS_TRAP_OLD_STATE;
+    // With nobody waiting the ticks went by without an interrupt, so the one it waits for may have to be found first
+    if (headBlocked(&PSEUDO_CLOCK_SEMAPHORE) == (proc_t*)ENULL) {
+        long currentTime;
+        STCK(&currentTime);
+        pseudoclockadvance(currentTime);
+    }
 
-    // Perform the LOCK operation on the pseudo-clock and switch execution flow
-    intsemop(&PSEUDO_CLOCK_SEMAPHORE, LOCK);
+    // Perform the LOCK operation on the pseudo-clock and switch execution flow, unless it could not block
+    if (intsemop(&PSEUDO_CLOCK_SEMAPHORE, LOCK)) {
+        SYS_TRAP_OLD_STATE->s_r[2] = ENOSEMD;
+    }
 }
 
 
@@ -211,9 +397,14 @@ void waitforio()
 
     // In the case where the device interrupt has NOT occured, BLOCK on that device's semaphore until we recieve the interrupt (V op)
     if (deviceSemaphores[deviceNumber] <= 0) {
-        // Update the process's current processor state as it will be blocked and its state will need to be reloaded later
-        process->p_s = *SYS_TRAP_OLD_STATE;
-        intsemop(&deviceSemaphores[deviceNumber], LOCK);
+        // A process that waits for I/O is interactive, it goes back to the top MLFQ level. intsemop only
+        // returns if it could not block, and then the process keeps running at the level it had
+        int level = process->p_level;
+        process->p_level = 0;
+        if (intsemop(&deviceSemaphores[deviceNumber], LOCK)) {
+            process->p_level = level;
+            SYS_TRAP_OLD_STATE->s_r[2] = ENOSEMD;
+        }
     }
     // Otherwise the interrupt has already occured which happens on a V (+1) operation, so this semahpore's value is 1
     else {
@@ -223,6 +414,9 @@ void waitforio()
 
         // Decrement (P) that devices semaphore as the device operation has already been completed, resuming this process's execution via LDST in trap.c
         deviceSemaphores[deviceNumber]--; 
+        if (semWatchCount > 0) {
+            semstatop(&deviceSemaphores[deviceNumber], TRUE);
+        }
     }
 }
 
@@ -244,8 +438,8 @@ void static inthandler(int deviceIndex)
 
         // The device registers are stored in memory, accessible and indexable with our deviceRegisters arr
         // wait-for-io also stores these values, return them
-        process->p_s.s_r[2] = deviceRegisters[deviceIndex]->d_dadd; // length
-        process->p_s.s_r[3] = deviceRegisters[deviceIndex]->d_stat; // status
+        process->p_cold->p_s.s_r[2] = deviceRegisters[deviceIndex]->d_dadd; // length
+        process->p_cold->p_s.s_r[3] = deviceRegisters[deviceIndex]->d_stat; // status
 
         // Unblock the waiting process by performing a V (+1) operation
         intsemop(&deviceSemaphores[deviceIndex], UNLOCK);
@@ -259,34 +453,34 @@ void static inthandler(int deviceIndex)
 
         // Increment the semaphore value to indicate the interrupt already occured
         deviceSemaphores[deviceIndex]++;
+        if (semWatchCount > 0) {
+            semstatop(&deviceSemaphores[deviceIndex], FALSE);
+        }
     }
 }
 
 
 /*
-    This function is called when the RQ is empty. If there are processes blocked on the pseudoclock, it calls intschedule() and it
-    goes to sleep. If there are processes blocked on the I/O semaphores it goes to sleep. If there are no processes left it shuts
+    This function is called when the RQ is empty. If there are processes blocked on the pseudoclock, in a timed P or on the
+    I/O semaphores, it calls intschedule() (so the Interval Timer only goes off for the next pseudo-clock tick or timed P
+    deadline, if any) and it goes to sleep. If there are no processes left it shuts
     down normally and it prints a normal termination message. Otherwise it prints a deadlock message.
 */
 void intdeadlock()
 {
-    // One or more processes are blocked on the pseudo semaphore clock
-    if (headBlocked(&PSEUDO_CLOCK_SEMAPHORE) != (proc_t*)ENULL) {
-        // Call intschedule to prepare a timer interrupt to invoke intclockhandler to load the next process on the RQ
-        intschedule();
-
-        // Halt the CPU while we wait for this device's interrupt to occur 
-        sleep();
-    }
+    // One or more processes are blocked on the pseudo semaphore clock or in a timed P, and a clock interrupt will wake them
+    int waiting = (headBlocked(&PSEUDO_CLOCK_SEMAPHORE) != (proc_t*)ENULL || timedWaiters != (proc_t*)ENULL);
 
     // In case where we are waiting for devices to send an interrupt as indication for the completion of some operation
     int i;
-    for (i = 0; i < TOTAL_DEVICES; i++) {
-        // if any process is blocked on an I/O semaphore, sleep so the CPU can conserve resources
-        if (headBlocked(&deviceSemaphores[i]) != (proc_t*)ENULL) {
-            // Halt the CPU while we wait for this device's interrupt to occur 
-            sleep();
-        }
+    for (i = 0; i < TOTAL_DEVICES && !waiting; i++) {
+        waiting = (headBlocked(&deviceSemaphores[i]) != (proc_t*)ENULL);
+    }
+
+    if (waiting) {
+        // Set the timer for the clock event it waits for (or none), and halt the CPU while we wait for the interrupt to occur
+        intschedule((proc_t*)ENULL);
+        sleep();
     }
 
     // If we reach this point, this means there are no process blocked on I/O semaphores OR on the pseudo-clock semaphore
@@ -303,36 +497,55 @@ void intdeadlock()
 
 
 /*
-    If the RQ is not empty, this function removes the process at the head of the queue and it then adds it to 
-    the tail of the queue. This function does an intsemop(UNLOCK) on the pseudoclock semaphore if
-    necessary and then it calls schedule() to begin the execution of the process at the head of the RQ.
+    The Interval Timer is only set for the next clock event (see intsettimer()), so this function deals with the ones
+    that are due. It does an intsemop(UNLOCK) on the pseudoclock semaphore once a tick has come, and expires the timed
+    P's whose deadline has passed. If the time slice of the running process is over and another process is ready, it
+    removes the running process from the head of the RQ, one MLFQ level down, and it then adds it to the tail of the
+    queue. It boosts the MLFQ levels every MLFQBOOST microseconds, and then it calls schedule() to begin the execution
+    of the next process. Otherwise the running process continues (unless a process released here preempts it) with the
+    timer set for the next event.
 */
 void static intclockhandler()
 {
     // Grab the process running on the CPU
     proc_t* process = headQueue(readyQueue);
+    long currentTime;
+    STCK(&currentTime);
+
+    // Unblock the first sleeping process on the pseudo clock semaphore once the tick has come
+    if (pseudoclockadvance(currentTime) && headBlocked(&PSEUDO_CLOCK_SEMAPHORE) != (proc_t*)ENULL) {
+        intsemop(&PSEUDO_CLOCK_SEMAPHORE, UNLOCK);
+    }
 
-    // Only the hardware timer can generate clock interrupts. Since every interrupt should happen a qunatum apart, add it to the pseudo-clock
-    PSEUDO_CLOCK += QUANTUM;
+    // Put the processes whose timed P has run out back on the RQ
+    if (timedWaiters != (proc_t*)ENULL) {
+        expiretimedwaits();
+    }
 
-    // Perform Round robin, remove process at head and add it to tail of RQ
-    if (process != (proc_t*)ENULL) {
+    // Perform Round robin once the time slice is over, remove process at head and add it to tail of RQ (unless it is the only one ready)
+    int preempted = (process != (proc_t*)ENULL && currentTime >= sliceEnd && othersready());
+    if (preempted) {
         // Update the running process's state before we load next process on CPU
         removeProc(&readyQueue);
         updateTotalTimeOnProcessor(process);
-        process->p_s = *CLOCK_INTERRUPT_OLD_STATE;
+        process->p_cold->p_s = *CLOCK_INTERRUPT_OLD_STATE;
+        process->p_level = MIN(process->p_level + 1, MLFQLEVELS - 1);
         insertProc(&readyQueue, process);
     }
 
-    // Check how much time has passed on the pseudo-clock and unblock the first sleeping process on the pseudo clock semaphore if possible
-    if (PSEUDO_CLOCK >= 100000) {
-        if (headBlocked(&PSEUDO_CLOCK_SEMAPHORE) != (proc_t*)ENULL) {
-            intsemop(&PSEUDO_CLOCK_SEMAPHORE, UNLOCK);
-        }
-        PSEUDO_CLOCK = 0;
+    // Periodically give every ready process the top MLFQ level back
+    if (currentTime >= nextBoost) {
+        mlfqboost();
+        nextBoost = currentTime + MLFQBOOST;
     }
 
-    // This call primes the Interval Timer to throw an interrupt when the RQ is NOT empty, triggering a round robin pre-emption cycle
+    // The running process keeps the CPU, with the timer set for the next event
+    if (process != (proc_t*)ENULL && !preempted) {
+        intsettimer(process);
+        intresume(process, CLOCK_INTERRUPT_OLD_STATE);
+    }
+
+    // This call primes the Interval Timer for the next process on the RQ, or goes idle
     schedule();
 }
 
@@ -353,14 +566,8 @@ void static intterminalhandler()
     // This adds the process that was blocked on this device's IO resource back to the RQ
     inthandler(deviceNumber);
 
-    // If the RQ was not empty when the interrupt occured, continue executing the current process
-    if (process != (proc_t*)ENULL) {
-        LDST(TERM_INTERRUPT_OLD_STATE);
-    }
-    // Otherwise we call schedule to prime the Interval Timer and load the next process on the RQ or deadlock
-    else {
-        schedule();
-    }
+    // Continue executing the current process, unless the RQ was empty or the released process preempts it
+    intresume(process, TERM_INTERRUPT_OLD_STATE);
 }
 
 
@@ -377,14 +584,8 @@ void static intprinterhandler()
     // This adds the process that was blocked on this device's IO resource back to the RQ
     inthandler(deviceNumber + 5);
 
-    // If the RQ was not empty when the interrupt occured, continue executing the current process
-    if (process != (proc_t*)ENULL) {
-        LDST(PRINTER_INTERRUPT_OLD_STATE);
-    }
-    // Otherwise we call schedule to prime the Interval Timer and load the next process on the RQ or deadlock
-    else {
-        schedule();
-    }
+    // Continue executing the current process, unless the RQ was empty or the released process preempts it
+    intresume(process, PRINTER_INTERRUPT_OLD_STATE);
 }
 
 
@@ -401,14 +602,8 @@ void static intdiskhandler()
     // This adds the process that was blocked on this device's IO resource back to the RQ
     inthandler(deviceNumber + 7);
 
-    // If the RQ was not empty when the interrupt occured, continue executing the current process
-    if (process != (proc_t*)ENULL) {
-        LDST(DISK_INTERRUPT_OLD_STATE);
-    }
-    // Otherwise we call schedule to prime the Interval Timer and load the next process on the RQ or deadlock
-    else {
-        schedule();
-    }
+    // Continue executing the current process, unless the RQ was empty or the released process preempts it
+    intresume(process, DISK_INTERRUPT_OLD_STATE);
 }
 
 
@@ -425,14 +620,36 @@ void static intfloppyhandler()
     // This adds the process that was blocked on this device's IO resource back to the RQ
     inthandler(deviceNumber + 11);
 
-    // If the RQ was not empty when the interrupt occured, continue executing the current process
-    if (process != (proc_t*)ENULL) {
-        LDST(FLOPPY_INTERRUPT_OLD_STATE);
+    // Continue executing the current process, unless the RQ was empty or the released process preempts it
+    intresume(process, FLOPPY_INTERRUPT_OLD_STATE);
+}
+
+
+/*
+    Called by the device interrupt handlers once the interrupt is dealt with. If the RQ was empty it calls schedule().
+    Otherwise the interrupted process continues, unless the interrupt released a process at a higher MLFQ level: the
+    interrupted process then goes back to the RQ (keeping its level) and schedule() runs the released one right away.
+    Under SCHEDSTRIDE the released process waits for the next schedule() like any other.
+*/
+void static intresume(proc_t* process, state_t* oldState)
+{
+    if (process == (proc_t*)ENULL) {
+        schedule();
     }
-    // Otherwise we call schedule to prime the Interval Timer and load the next process on the RQ or deadlock
-    else {
+
+    // A released process was added at the tail of the RQ
+    proc_t* released = readyQueue.next;
+    if (schedPolicy == SCHEDMLFQ && released != process && released->p_level < process->p_level) {
+        removeProc(&readyQueue);
+        updateTotalTimeOnProcessor(process);
+        process->p_cold->p_s = *oldState;
+        insertProc(&readyQueue, process);
         schedule();
     }
+
+    // A process the interrupt released will take over once the time slice of this one is over
+    intcheckslice();
+    LDST(oldState);
 }
 
 
@@ -514,4 +731,10 @@ void intinit()
     CLOCK_INTERRUPT_NEW_STATE->s_sr.ps_int = 7;                                     // Interrupt Priority disabled
     CLOCK_INTERRUPT_NEW_STATE->s_sp = MEMSTART;					                    // Set the global stack pointer to the top, where the Kernel memory is allocated
     CLOCK_INTERRUPT_NEW_STATE->s_pc = (int)intclockhandler;		                    // The address for this specific handler
+
+    // The pseudo-clock ticks every PSEUDOTICK microseconds from now on, and the MLFQ levels are boosted every MLFQBOOST
+    long currentTime;
+    STCK(&currentTime);
+    nextPseudoTick = currentTime + PSEUDOTICK;
+    nextBoost = currentTime + MLFQBOOST;
 }
@@ -10,8 +10,8 @@
 
 /*
     This module coordinates the initialization of the nucleus and it starts
-    the execution of the first process, p1(). It also provides a scheduling
-    function. The module contains three routines:
+    the execution of the first process, p1(). It also provides the scheduler.
+    The module contains these routines:
 
     - void main()
     This function calls init(), sets up the processor state [state_t] for p1(),
@@ -19,21 +19,90 @@
 
     - void static init():
     This function determines how much phyiscal memory there is in the system. It
-    then calls initProc(), initSemd(), trapinit(), and intinit()
+    then calls initProc(), initSemd(), trapinit(), mutexinit() and intinit(), and carves the
+    EXTRAPROC/EXTRASEMD table entries out of the memory below the kernel stack
 
     - void schedule()
-    if the RQ is not empty this function calls intschedule() and loads the state of
-    the process at the head of the RQ. If the RQ is empty it calls intdeadlock().
+    this function picks the next process with the scheduling policy below. If there is one
+    it calls intschedule() and loads its state, otherwise it calls intdeadlock().
+
+    - proc_t* outReady(proc_t* p), int othersready(), void mlfqboost(), int setschedpolicy(int policy),
+      void stridetickets(proc_t* p, int tickets)
+    take a ready process off the RQ or the queue it waits on, tell if anyone but the running
+    process is ready, move every ready process to MLFQ level 0, change the scheduling policy (SETSCHED),
+    and change the stride tickets of a process.
+
+    The RQ only holds the running process at its head, followed by the processes that became
+    ready while it ran (created, or released from a semaphore), so the rest of the nucleus
+    still finds the running process at the head of the RQ and puts ready processes at its
+    tail. schedule() first moves the RQ onto the queues of the policy in use (schedPolicy,
+    SCHEDPOLICY at boot) and then picks from them.
+
+    SCHEDMLFQ is a multilevel feedback queue. Every process has a level (p_level), 0 being the
+    top, and the ready processes waiting for the CPU are on levelQueue[p_level]. The head of
+    the highest non-empty one runs next.
+    - A process preempted by the clock has used its whole quantum and drops one level
+    - A process that blocks on I/O (SYS8) goes back to level 0, and one released by a device
+      interrupt preempts the interrupted process if its level is higher (int.c)
+    - Every MLFQBOOST microseconds every ready process goes back to level 0 (mlfqboost())
+
+    SCHEDSTRIDE is stride scheduling. The time a process spends on the CPU advances its pass
+    (p_pass) by STRIDE1 / p_tickets per microsecond (updateTotalTimeOnProcessor() in trap.c),
+    the ready processes wait on strideQueue, and the one with the lowest pass runs next. So
+    over time each process gets CPU time in proportion to its tickets. A process that becomes
+    ready with a pass below that of the last process dispatched (stridePass) is moved up to
+    it, so time spent blocked is not banked as credit.
 */
 
+/* The kernel stack takes the top two pages of memory, right below MEMSTART */
+#define KERNELSTACK (PAGESIZE * 2)
+
+/* Bytes carved below the kernel stack for the extra table entries (kept a multiple of 4) */
+#define CARVEDBYTES ((EXTRAPROC * (sizeof(proc_t) + sizeof(proc_cold)) + EXTRASEMD * sizeof(semd_t) + 3) & ~3)
+
 int MEMSTART;
+int P1STACK;            /* Top of p1's stack, below the kernel stack and the carved tables */
 proc_link readyQueue;
+proc_link levelQueue[MLFQLEVELS];
+proc_link strideQueue;
+int schedPolicy = SCHEDPOLICY;
+long stridePass = 0;    /* p_pass of the process last dispatched under SCHEDSTRIDE */
 
 extern int p1();
+extern int end();
 extern void trapinit();
+extern void mutexinit();
+extern void myprint(char*);
 extern void updateLastStartTime(proc_t* p);
 
 
+/*
+    Grow the process and semaphore tables past their static sizes with EXTRAPROC and EXTRASEMD
+    entries taken from the memory just below the kernel stack. Everything else the nucleus
+    places under MEMSTART (p1's stack) is moved below the carved area.
+*/
+void static carvetables()
+{
+    char* carvedTop = (char*)(MEMSTART - KERNELSTACK);
+    char* carvedBottom = carvedTop - CARVEDBYTES;
+
+    // The carved area and p1's stack must stay clear of the loaded program
+    if ((int)carvedBottom - PAGESIZE <= (int)end) {
+        myprint("nucleus: not enough memory for EXTRAPROC/EXTRASEMD");
+        HALT();
+    }
+
+    // Descriptors go at the bottom of the area, then the cold parts of the process entries, then the entries
+    semd_t* extraSemds = (semd_t*)carvedBottom;
+    proc_cold* extraColds = (proc_cold*)(carvedBottom + EXTRASEMD * sizeof(semd_t));
+    proc_t* extraProcs = (proc_t*)(extraColds + EXTRAPROC);
+    extendSemd(extraSemds, EXTRASEMD);
+    extendProc(extraProcs, extraColds, EXTRAPROC);
+
+    P1STACK = (int)carvedBottom;
+}
+
+
 void static init()
 {
     // Initialize the processor state area for p1()
@@ -45,14 +114,137 @@ void static init()
     // Grab the global stack pointer which is at the top of memory
     MEMSTART = globalState.s_sp;
 
-    // Prep RQ
+    // Prep RQ and the MLFQ level queues
     readyQueue.index = ENULL;
     readyQueue.next = (proc_t*)ENULL;
+    int level;
+    for (level = 0; level < MLFQLEVELS; level++) {
+        levelQueue[level].index = ENULL;
+        levelQueue[level].next = (proc_t*)ENULL;
+    }
+    strideQueue.index = ENULL;
+    strideQueue.next = (proc_t*)ENULL;
 
     initProc(); // Initialize Process Free List
     initSemd(); // Initialize In-active Semaphore List
     trapinit(); // Initialize EVT + Prog, MM, and SYS Trap Areas
+    mutexinit(); // No mutex is held
     intinit();  // Initialize Interrupt Areas and Device registers
+
+    // Add the entries carved from memory below the kernel stack to the process and semaphore free lists
+    carvetables();
+}
+
+
+/*
+    Take the ready process p off the RQ or the queue it waits on. Return p, or ENULL if it was on none.
+*/
+proc_t* outReady(proc_t* p)
+{
+    if (outProc(&readyQueue, p) != (proc_t*)ENULL) {
+        return p;
+    }
+    if (schedPolicy == SCHEDSTRIDE) {
+        return outProc(&strideQueue, p);
+    }
+    return outProc(&levelQueue[p->p_level], p);
+}
+
+
+/*
+    Return TRUE if a process other than the running one (the head of the RQ) is ready to run, FALSE otherwise.
+*/
+int othersready()
+{
+    if (readyQueue.next != headQueue(readyQueue) || strideQueue.next != (proc_t*)ENULL) {
+        return TRUE;
+    }
+
+    int level;
+    for (level = 0; level < MLFQLEVELS; level++) {
+        if (levelQueue[level].next != (proc_t*)ENULL) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
+/*
+    Make policy (SCHEDMLFQ or SCHEDSTRIDE) the scheduling policy. The ready processes go back on the RQ,
+    behind the running process, and schedule() moves them to the queues of the new policy.
+    Return TRUE if policy is not a scheduling policy, FALSE otherwise.
+*/
+int setschedpolicy(int policy)
+{
+    if (policy != SCHEDMLFQ && policy != SCHEDSTRIDE) {
+        return TRUE;
+    }
+
+    int level;
+    for (level = 0; level < MLFQLEVELS; level++) {
+        spliceProc(&levelQueue[level], &readyQueue);
+    }
+    spliceProc(&strideQueue, &readyQueue);
+    schedPolicy = policy;
+    return FALSE;
+}
+
+
+/*
+    Take the process with the lowest pass (the first of them if several) off strideQueue and return it,
+    or ENULL if the queue is empty. Passes are compared by their difference, so they may wrap around.
+*/
+proc_t* stridenext()
+{
+    proc_t* next = headQueue(strideQueue);
+    if (next == (proc_t*)ENULL) {
+        return next;
+    }
+
+    proc_t* process;
+    for (process = nextProc(&strideQueue, next); process != (proc_t*)ENULL; process = nextProc(&strideQueue, process)) {
+        if (process->p_pass - next->p_pass < 0) {
+            next = process;
+        }
+    }
+
+    stridePass = next->p_pass;
+    return outProc(&strideQueue, next);
+}
+
+
+/*
+    Give p tickets stride tickets. The part of its pass still ahead of the last process dispatched is
+    scaled to the new tickets, so a process given more of them gets to run sooner and not only longer.
+*/
+void stridetickets(proc_t* p, int tickets)
+{
+    if (p->p_pass - stridePass > 0) {
+        p->p_pass = stridePass + (p->p_pass - stridePass) * p->p_tickets / tickets;
+    }
+    p->p_tickets = tickets;
+}
+
+
+/*
+    Move every ready process back to the top MLFQ level, so the ones that kept dropping levels are not starved.
+    Processes blocked at the time keep their level until they are next scheduled.
+*/
+void mlfqboost()
+{
+    proc_t* process;
+    for (process = headQueue(readyQueue); process != (proc_t*)ENULL; process = nextProc(&readyQueue, process)) {
+        process->p_level = 0;
+    }
+
+    int level;
+    for (level = 1; level < MLFQLEVELS; level++) {
+        for (process = headQueue(levelQueue[level]); process != (proc_t*)ENULL; process = nextProc(&levelQueue[level], process)) {
+            process->p_level = 0;
+        }
+        spliceProc(&levelQueue[level], &levelQueue[0]);
+    }
 }
 
 
@@ -62,14 +254,41 @@ void schedule()
     // Prepare to run next process in RQ
     proc_t* runningProcess;
 
-    if ((runningProcess = headQueue(readyQueue)) != (proc_t*)ENULL) {
-        state_t state = runningProcess->p_s;
-        // Prime the Interval Timer
-        intschedule();
+    // The processes made ready since the last call wait at the tail of their level (or on strideQueue), in the order they became ready
+    while ((runningProcess = removeProc(&readyQueue)) != (proc_t*)ENULL) {
+        if (schedPolicy == SCHEDSTRIDE) {
+            if (runningProcess->p_pass - stridePass < 0) {
+                runningProcess->p_pass = stridePass;
+            }
+            insertProc(&strideQueue, runningProcess);
+        }
+        else {
+            insertProc(&levelQueue[runningProcess->p_level], runningProcess);
+        }
+    }
+
+    // The process with the lowest pass, or the head of the highest non-empty level, runs next alone on the RQ
+    if (schedPolicy == SCHEDSTRIDE) {
+        runningProcess = stridenext();
+    }
+    int level;
+    for (level = 0; level < MLFQLEVELS && runningProcess == (proc_t*)ENULL; level++) {
+        runningProcess = removeProc(&levelQueue[level]);
+    }
+
+    if (runningProcess != (proc_t*)ENULL) {
+        insertProc(&readyQueue, runningProcess);
+
+        // A process loaded after a timed P got its units in time, so its deadline is dropped
+        if (runningProcess->p_cold->wait_deadline != 0) {
+            canceltimedwait(runningProcess);
+        }
+        // Prime the Interval Timer with this process's time slice
+        intschedule(runningProcess);
         // Update this process's current start time
         updateLastStartTime(runningProcess);
-        // Load this process's state into the CPU
-        LDST(&state);
+        // Load this process's state into the CPU, straight from where it was saved when it left the CPU
+        LDST(&runningProcess->p_cold->p_s);
     } 
     else {
         // This will put the CPU is an idle state to consume resources until an interrupt occurs
@@ -89,13 +308,13 @@ void main()
     // Prepare the processor state in the CPU for p1. Populate some registers, SP, and PC
     state_t initialProcState;
 
-    // Update the stack pointer and move it down from the Kernel chunk memory to prevent overriding Kernel routines
-    initialProcState.s_sp = MEMSTART - PAGESIZE*2; 
+    // Update the stack pointer and move it down from the Kernel chunk memory (and the carved tables) to prevent overriding Kernel routines
+    initialProcState.s_sp = P1STACK; 
     initialProcState.s_sr.ps_m = 0;						// Set memory management to physical addressing (no process virutalization)
     initialProcState.s_sr.ps_s = 1;						// Switch to Supervisor Mode to run initial process
     initialProcState.s_sr.ps_int = 7;					// All interrupts disabled for initial process p1
     initialProcState.s_pc = (int)p1;					// Set the Program Counter to p1's address
-    initialProcess->p_s = initialProcState;				// Update proc_t with the the current processor state
+    initialProcess->p_cold->p_s = initialProcState;				// Update proc_t with the the current processor state
 
     // Insert the initial process into the RQ
     insertProc(&readyQueue, initialProcess);
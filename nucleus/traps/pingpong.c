@@ -0,0 +1,91 @@
+#include "../../h/const.h"
+#include "../../h/types.h"
+#include "../../h/vpop.h"
+
+/*
+ *	Uncontended semop timing, run as p1 in place of p1.2.c ("make pingpong").
+ *
+ *	The first loop P's and V's a free semaphore, so no call ever blocks.
+ *	The second bounces between p1 and pong on two semaphores, so every P
+ *	blocks and every V releases the other process. Both use verhogen and
+ *	passeren from libutil, a vector of one vpop, and are timed with STCK.
+ *
+ *	Build it as pingpong (with the single P/V fast path of SYS3) and as
+ *	pingpong_slow (-DNOSEMOPFAST, every semop through the general loop),
+ *	and compare the microseconds per semop left in uncontended and
+ *	pingpong (look at them with gdb once the nucleus halts).
+ */
+
+#define	DO_CREATEPROC		SYS1	/* create process */
+#define	DO_SEMOP			SYS3	/* V or P a semaphore */
+
+#define	DO_PASSERN		passeren	/* P a semaphore */
+#define	DO_VERHOGEN		verhogen	/* V a semaphore */
+
+#define	ROUNDS			10000	/* P/V pairs of each loop */
+
+register int r2 asm("%d2");
+register int r3 asm("%d3");
+register int r4 asm("%d4");
+
+int		lock=1,			/* free for the first loop */
+		ping=0,			/* p1 -> pong */
+		pong=0,			/* pong -> p1 */
+		endpong=0;		/* pong is done */
+
+state_t		pongstate;
+
+long		uncontended,		/* microseconds per semop, first loop */
+		pingpong;		/* microseconds per semop, second loop */
+
+int		pongp();
+
+
+p1()
+{
+	long	start, end;
+	int	i;
+
+	/* a free semaphore: every semop returns to the caller */
+	STCK(&start);
+	for (i = 0; i < ROUNDS; i++) {
+		DO_PASSERN(&lock);
+		DO_VERHOGEN(&lock);
+	}
+	STCK(&end);
+	uncontended = (end - start) / (2 * ROUNDS);
+
+	STST(&pongstate);
+	pongstate.s_sp -= PAGESIZE*2;
+	pongstate.s_pc = (int)pongp;
+	r4 = (int)&pongstate;
+	DO_CREATEPROC();
+
+	/* every P blocks until the other process V's it */
+	STCK(&start);
+	for (i = 0; i < ROUNDS; i++) {
+		DO_VERHOGEN(&ping);
+		DO_PASSERN(&pong);
+	}
+	STCK(&end);
+	pingpong = (end - start) / (4 * ROUNDS);
+
+	DO_PASSERN(&endpong);
+	HALT();
+}
+
+
+pongp()
+{
+	int	i;
+
+	for (i = 0; i < ROUNDS; i++) {
+		DO_PASSERN(&ping);
+		DO_VERHOGEN(&pong);
+	}
+	DO_VERHOGEN(&endpong);
+
+	/* stay blocked so p1 decides when the nucleus halts */
+	DO_PASSERN(&lock);
+	DO_PASSERN(&lock);
+}
@@ -0,0 +1,81 @@
+#include "../../h/const.h"
+#include "../../h/types.h"
+
+/*
+ *	Stride scheduling shares, run as p1 in place of p1.2.c ("make stride").
+ *
+ *	p1 switches the nucleus to SCHEDSTRIDE (SYS4 SETSCHED) and creates
+ *	SPINNERS processes that do nothing but ask SYS6 for their CPU time,
+ *	holding 1, 2 and 3 times TICKETS tickets (SYS4 SETTICKETS, which the
+ *	child inherits). After RUNTICKS ticks of the pseudo-clock p1 works out
+ *	each spinner's share of the CPU time they used together, in tenths of
+ *	a percent, and halts. Look at cputime and share with gdb once the
+ *	nucleus halts: share should be close to 167, 333 and 500.
+ */
+
+#define	DO_CREATEPROC		SYS1	/* create process */
+#define	DO_NUCLEUSCTL		SYS4	/* nucleus settings, function in D2 */
+#define	DO_GETCPUTIME		SYS6	/* get cpu time used to date */
+#define	DO_WAITCLOCK		SYS7	/* delay on the clock semaphore */
+
+#define	SPINNERS		3	/* CPU-bound processes */
+#define	RUNTICKS		20	/* pseudo-clock ticks they run for */
+
+register int r2 asm("%d2");
+register int r3 asm("%d3");
+register int r4 asm("%d4");
+
+state_t		spinstate[SPINNERS];
+
+long		cputime[SPINNERS],	/* CPU time of each spinner, from SYS6 */
+		share[SPINNERS];	/* its share of their total, in 1/1000 */
+
+int		spinner();
+
+
+p1()
+{
+	long	total;
+	int	i;
+
+	r2 = SETSCHED;
+	r4 = SCHEDSTRIDE;
+	DO_NUCLEUSCTL();
+
+	for (i = 0; i < SPINNERS; i++) {
+		r2 = SETTICKETS;
+		r4 = (i + 1) * TICKETS;
+		DO_NUCLEUSCTL();
+
+		/* the spinner finds its index in D2, and can be preempted */
+		STST(&spinstate[i]);
+		spinstate[i].s_sp -= PAGESIZE * 2 * (i + 1);
+		spinstate[i].s_pc = (int)spinner;
+		spinstate[i].s_sr.ps_int = 0;
+		spinstate[i].s_r[2] = i;
+		r4 = (int)&spinstate[i];
+		DO_CREATEPROC();
+	}
+
+	for (i = 0; i < RUNTICKS; i++)
+		DO_WAITCLOCK();
+
+	total = 0;
+	for (i = 0; i < SPINNERS; i++)
+		total += cputime[i];
+	for (i = 0; i < SPINNERS; i++)
+		share[i] = total > 0 ? cputime[i] * 1000 / total : 0;
+
+	HALT();
+}
+
+
+spinner()
+{
+	int	me = r2;
+
+	for (;;) {
+		DO_GETCPUTIME();
+		cputime[me] = r2;
+	}
+}
@@ -6,6 +6,7 @@
 #include "../../h/const.h"
 #include "../../h/procq.e"
 #include "../../h/asl.e"
+#include "../../h/int.e"
 #include "../../h/vpop.h"
 
 /*
@@ -26,10 +27,44 @@
 */
 
 extern proc_link readyQueue;
+extern proc_link levelQueue[];
 extern void schedule();
+extern proc_t* outReady(proc_t* p);
+extern int setschedpolicy(int policy);
+extern void stridetickets(proc_t* p, int tickets);
+extern void updateTotalTimeOnProcessor(proc_t* process);
 
-void killprocrecurse(proc_t* p);
+/*
+    A mutex is a semaphore word that starts at 1, taken with MLOCK and given back with MUNLOCK (see semop).
+    Unlike a plain semaphore the nucleus records which process holds it, so the holder can inherit the
+    priority of the processes waiting for it and the mutex can be handed on if the holder is killed.
+*/
+typedef struct mutex_t {
+    int* m_addr;                /* the mutex word, or ENULL if this entry is not in use */
+    proc_t* m_owner;            /* process holding the mutex */
+} mutex_t;
+
+mutex_t mutexTable[MAXMUTEX];
+
+/* Semaphores whose contention statistics are kept (see SEMWATCH), the first semWatchCount entries are in use */
+semstat semWatches[SEMWATCHES];
+int semWatchCount = 0;
+
+proc_t* killprocrecurse(proc_t* p, proc_t* killed);
 void killproc();
+mutex_t* findMutex(int* mutexAddr);
+int lockMutex(int* mutexAddr, proc_t* process);
+void unlockMutex(mutex_t* mutex);
+void inheritPriority(proc_t* owner, proc_t* waiter);
+void restorePriority(proc_t* process);
+int semstatwatch(int* semAddr);
+semstat* findsemstat(int* semAddr);
+void semstatop(int* semAddr, int isP);
+int semstatblock(int* semAddr);
+void semstatwait(proc_t* process, int* semAddr);
+proc_link* semstatqueue(proc_link* released);
+void semstatrelease(proc_link* released);
+void setquantumrecurse(proc_t* process, long quantum);
 
 
 void createproc()
@@ -54,22 +89,27 @@ void createproc()
 
         // Set the child's processor state
         state_t* childProcState = (state_t*)SYS_TRAP_OLD_STATE->s_r[4];
-        childProcess->p_s = *childProcState;
+        childProcess->p_cold->p_s = *childProcState;
 
-        // Update the parent process
-        childProcess->parent_proc = parentProcess;
+        // Update the parent process, whose priority and tickets (not counting any it inherited) and time slice the child starts with
+        childProcess->p_cold->parent_proc = parentProcess;
+        childProcess->p_priority = parentProcess->p_cold->base_priority;
+        childProcess->p_cold->base_priority = parentProcess->p_cold->base_priority;
+        childProcess->p_quantum = parentProcess->p_quantum;
+        childProcess->p_tickets = parentProcess->p_cold->base_tickets;
+        childProcess->p_cold->base_tickets = parentProcess->p_cold->base_tickets;
 
         // Insert child into parent children list
-        if (parentProcess->children_proc == (proc_t*)ENULL) {
-            parentProcess->children_proc = childProcess;
+        if (parentProcess->p_cold->children_proc == (proc_t*)ENULL) {
+            parentProcess->p_cold->children_proc = childProcess;
         }
         else {
             // Iterate through the parent's children to add the new Process as a sibling
-            proc_t* siblingProces = parentProcess->children_proc;
-            while (siblingProces->sibling_proc != (proc_t*)ENULL) {
-                siblingProces = siblingProces->sibling_proc;
+            proc_t* siblingProces = parentProcess->p_cold->children_proc;
+            while (siblingProces->p_cold->sibling_proc != (proc_t*)ENULL) {
+                siblingProces = siblingProces->p_cold->sibling_proc;
             }
-            siblingProces->sibling_proc = childProcess;
+            siblingProces->p_cold->sibling_proc = childProcess;
         }
 
         // Add the child process to the tail of RQ
@@ -78,28 +118,53 @@ void createproc()
 }
 
 
-// Recursive function to terminate process and its children
-void killprocrecurse(proc_t* process)
+// Recursive function to terminate process and its children. Every terminated process is pushed on
+// the killed list (linked through p_next) so the whole family can be freed in one splice
+proc_t* killprocrecurse(proc_t* process, proc_t* killed)
 {
     // Base case
     if (process == (proc_t*)ENULL) {
-        return;
+        return killed;
     }
 
     // DFS into the last child, then explore the children of this prcoess's siblings
-    proc_t* childProcess = process->children_proc;
+    proc_t* childProcess = process->p_cold->children_proc;
     while (childProcess != (proc_t*)ENULL) {
-        proc_t* nextChildProcess = childProcess->sibling_proc;
-        killprocrecurse(childProcess);
+        proc_t* nextChildProcess = childProcess->p_cold->sibling_proc;
+        killed = killprocrecurse(childProcess, killed);
         childProcess = nextChildProcess;
     }
 
-    // Backtrack and remove all of the process's progeny links and from ASL queues
-    if (outBlocked(process) == (proc_t*)ENULL) {
-        outProc(&readyQueue, process);
+    // Backtrack and remove all of the process's progeny links and from ASL queues. The units it was
+    // waiting for go back to each semaphore and may release the processes behind it
+    if (outBlockedRelease(process, &readyQueue) == (proc_t*)ENULL) {
+        outReady(process);
+    }
+
+    // The holder of a mutex it was waiting for no longer inherits its priority
+    if (process->p_cold->waiting_mutex != (int*)ENULL) {
+        mutex_t* mutex = findMutex(process->p_cold->waiting_mutex);
+        if (mutex != (mutex_t*)ENULL) {
+            restorePriority(mutex->m_owner);
+        }
+    }
+
+    // A process killed during a timed P must not be expired later
+    if (process->p_cold->wait_deadline != 0) {
+        canceltimedwait(process);
+    }
+
+    // Mutexes the process holds go to their next waiter
+    int m;
+    for (m = 0; m < MAXMUTEX; m++) {
+        if (mutexTable[m].m_addr != (int*)ENULL && mutexTable[m].m_owner == process) {
+            unlockMutex(&mutexTable[m]);
+        }
     }
 
-    freeProc(process);
+    // The process is on no queue now, so p_next can chain it to the other killed processes
+    process->p_next = killed;
+    return process;
 }
 
 
@@ -114,30 +179,30 @@ void killproc()
     proc_t* process = headQueue(readyQueue);
 
     // Set the parent child pointer to the killed process's immeadiate sibling
-    proc_t* parentProcess = process->parent_proc;
+    proc_t* parentProcess = process->p_cold->parent_proc;
 
     if (parentProcess != (proc_t*)ENULL) {
         // if the parent process child pointer starts with this process, make parent's first child this process's sibling
-        if (parentProcess->children_proc == process) {
-            parentProcess->children_proc = process->sibling_proc;
+        if (parentProcess->p_cold->children_proc == process) {
+            parentProcess->p_cold->children_proc = process->p_cold->sibling_proc;
         }
         else {
             // Otherwise find the sibling previous to the killed process and update its sibling pointer to the kill process's sibling
-            proc_t* child = parentProcess->children_proc;
+            proc_t* child = parentProcess->p_cold->children_proc;
 
-            while (child != (proc_t*)ENULL && child->sibling_proc != process) {
-                child = child->sibling_proc;
+            while (child != (proc_t*)ENULL && child->p_cold->sibling_proc != process) {
+                child = child->p_cold->sibling_proc;
             }
 
             if (child != (proc_t*)ENULL) {
-                child->sibling_proc = process->sibling_proc;
+                child->p_cold->sibling_proc = process->p_cold->sibling_proc;
             }
         }
     }
 
-    // Kill family tree and remove this process from the RQ
+    // Kill family tree and remove this process from the RQ, then return the whole family to the free list at once
     removeProc(&readyQueue);
-    killprocrecurse(process);
+    freeProcList(killprocrecurse(process, (proc_t*)ENULL));
 
     // Call schedule to exit this kernel routine, prime the IT, and load the next process on the RQ
     schedule();
@@ -149,10 +214,35 @@ void killproc()
     Each semaphore and corresponding operation is described in a vpop structure. The vpop structure is defined in "vpop.h".
     D4 contains the address of the vpop vector, and D3 contains the number of vpops in the vector
 
+    An op of -n is a P of n units and +n is a V of n units (LOCK and UNLOCK are the n = 1 cases).
+    A vector of one such P or V normally never gets here, see semopfast().
+
     - The P’s may or may not get the calling process stuck on a semaphore Q, if so it comes off the RQ
-    – The V’s on active semaphores will remove the process at the head of that Sem PTE Q, but only puts it back on the
-      RQ if its not on additional semaphore Q’
+    – The V’s on active semaphores will remove the processes at the head of that Sem PTE Q whose units are now
+      available, but only puts them back on the RQ if they are not on additional semaphore Q’
+    – A V-all (op VALL) releases every process on that Sem PTE Q at once, the same as one V per waiter
     – Returns to the process now at the head of the RQ.
+
+    A P can carry flags above its unit count (see vpop.h). When the vector holds a try or timed P,
+    D2 is 0 on return if every such P got its units and -1 otherwise:
+    – A try-P (TRYP(n)) that would block is not applied at all, and the rest of the vector still is
+    – A timed-P (TIMEDP(n)) blocks like a P, but for at most the microseconds passed in D2. When the deadline
+      passes first, the clock interrupt takes the process off every semaphore it is still blocked on
+      (giving those units back) and returns it to the RQ
+    – The any-P's (ANYP(n)) of a vector form one wait-any: the first of them to get its units fires, the
+      process leaves the queues of the others (their units go back), and D3 holds the index of the vpop
+      that fired (ENULL after a timeout). Any other P's in the vector must still all be satisfied.
+      An any-P that is also a try does not block; if no any-P fires and none blocked, D2 is -1.
+      An any-P past index ANYMAX of the vector is not applied, and D2 is -1
+
+    An op of MLOCK takes the mutex whose word is at sem, blocking (by priority) while another process
+    holds it; the holder then inherits the caller's priority until it gives the mutex up with MUNLOCK,
+    running at the top MLFQ level and with the caller's stride tickets if it has fewer.
+    If the mutex cannot be taken (the word was not set up as a free mutex, the caller already holds
+    it, or MAXMUTEX mutexes are held) or given up (the caller does not hold it), D2 is -1 on return.
+
+    A P (or MLOCK) that has to block on a semaphore with no descriptor when none are free is undone
+    instead, and D2 is ENOSEMD on return. This takes precedence over the -1 of the other failures.
 */
 void semop()
 {
@@ -164,60 +254,630 @@ void semop()
     int len = SYS_TRAP_OLD_STATE->s_r[3];
     vpop* semOperations = (vpop*)SYS_TRAP_OLD_STATE->s_r[4];
 
+    // Try and timed P's report in D2, which holds the timeout of a timed P on the way in
+    int reportStatus = FALSE;
+    int timedWait = FALSE;
+    int status = 0;
+    long timeout = SYS_TRAP_OLD_STATE->s_r[2];
+
+    // A wait-any keeps the index of the P that fired in the caller's saved D3, where releaseBlocked leaves it too
+    proc_t* callingProcess = headQueue(readyQueue);
+    int anyWait = FALSE;
+    int anyBlocked = FALSE;
+
+    // The caller is running, so it is not waiting for a mutex (it may have timed out of that wait)
+    callingProcess->p_cold->waiting_mutex = (int*)ENULL;
+
+    // Statistics: the processes each op releases end their waits as they go to the RQ, and the
+    // caller's wait (if it blocks) is charged to the first watched semaphore it blocks on
+    proc_link released;
+    int* watchedSem = (int*)ENULL;
+
     // Iterate thorugh each entry and peform action on semaphore with given address based on the operation type
     int i;
     for (i = 0; i < len; i++) {
         int op = semOperations[i].op;			// Get operation to be performed on semaphore
         int* semAddr = semOperations[i].sem;	// Get the semaphore address
         int prevSemVal = *semAddr;				// Get the semaphore proper
-        *semAddr = prevSemVal + op;				// Update the semaphore
+        int flags = 0;
+        int applied = TRUE;						// FALSE if the op is refused, and so not counted in the statistics
+
+        // Split the try/timed/any flags of a P from its unit count
+        if (op < 0 && op > -VALL && (-op & (PANY | PTRY | PTIMED))) {
+            flags = -op & (PANY | PTRY | PTIMED);
+            op = -(-op & PUNITS);
+            reportStatus = reportStatus || (flags & (PTRY | PTIMED));
+        }
 
-        // P (-1) will decrement the semaphore, if the sem value is negative afterwards, the interrupted process should be blocked
-        if (op == LOCK) {
-            if (prevSemVal <= 0) {
-                // Semaphore has become negative, meaning its blocking at least the process and is now active
+        // The first any-P of the vector starts the wait-any with nothing fired yet
+        if ((flags & PANY) && !anyWait) {
+            anyWait = TRUE;
+            callingProcess->p_cold->p_s.s_r[3] = ENULL;
+        }
+
+        // Once a P of the wait-any has fired the rest of them are skipped
+        if ((flags & PANY) && callingProcess->p_cold->p_s.s_r[3] != ENULL) {
+            continue;
+        }
+        // The link node of a blocked P keeps the index of its any-P in a short, so one past that is refused
+        else if ((flags & PANY) && i > ANYMAX) {
+            reportStatus = TRUE;
+            status = MIN(status, -1);
+            applied = FALSE;
+        }
+        // An any-P that can have its units now fires, and the caller leaves the any-P's it blocked on so far
+        else if ((flags & PANY) && prevSemVal >= -op) {
+            *semAddr = prevSemVal + op;
+            callingProcess->p_cold->p_s.s_r[3] = i;
+            outBlockedAny(callingProcess, semstatqueue(&released));
+            semstatrelease(&released);
+        }
+        // A try-P that would block leaves the semaphore alone and only reports the failure
+        else if (op < 0 && op > -VALL && (flags & PTRY) && prevSemVal < -op) {
+            status = (flags & PANY) ? status : MIN(status, -1);
+            applied = FALSE;
+        }
+        // P (-n) takes n units off the semaphore, if fewer than n were available the interrupted process should be blocked
+        else if (op < 0 && op > -VALL) {
+            *semAddr = prevSemVal + op;			// Update the semaphore
+            if (prevSemVal < -op) {
+                // Semaphore does not have the units, meaning its blocking at least the process and is now active
                 // The running process at the head of the Queue can be blocked by a P operation 
                 // we do not want this to prevent other processes from being unblocked, so use a flag
+                // The process records how many units it waits for so it is only released once they are all there
+                if (insertBlockedAny(semAddr, callingProcess, -op, (flags & PANY) ? i : ENULL)) {
+                    // No descriptor is left for the semaphore, so the P is undone and reported rather than losing the caller
+                    *semAddr = prevSemVal;
+                    reportStatus = TRUE;
+                    status = MIN(status, ENOSEMD);
+                    continue;
+                }
                 callingProcessBlocked = TRUE;
-                proc_t* callingProcess = headQueue(readyQueue);
-                callingProcess->p_s = *SYS_TRAP_OLD_STATE;
-                insertBlocked(semAddr, callingProcess);
+                timedWait = timedWait || (flags & PTIMED);
+                anyBlocked = anyBlocked || (flags & PANY);
+                if (semWatchCount > 0 && semstatblock(semAddr) && watchedSem == (int*)ENULL) {
+                    watchedSem = semAddr;
+                }
             }
             else {
                 // Do nothing if the semaphore still has resources
             }
         }
-        // V (+1) on an active semaphore (-value) means a resource has been freed, allowing the next blocked process on that Semaphore to maybe be put back on RQ
-        else if (op == UNLOCK) {
-            if (prevSemVal < 0) {
-                // Remove the process at the head of the corresponding Semaphore Queue and update Semvec
-                proc_t* process = removeBlocked(semAddr);
-
-                // If the process is no longer blocked on any Semaphores, then add it back to the RQ
-                if (process != (proc_t*)ENULL && process->qcount == 0) {
-                    insertProc(&readyQueue, process);
-                }
+        // V (+n) on an active semaphore means n resources have been freed, allowing the blocked processes at the head of that Semaphore to maybe be put back on RQ
+        else if (op > 0 && op < VALL) {
+            *semAddr = prevSemVal + op;			// Update the semaphore
+
+            // Release waiters in order for as long as the units each one needs are there. Those no
+            // longer blocked on any Semaphores are added back to the RQ
+            releaseBlocked(semAddr, semstatqueue(&released));
+            semstatrelease(&released);
+        }
+        // V-all gives every process blocked on the semaphore its V at once
+        else if (op == VALL) {
+            // The blocked queue is spliced onto the RQ in one pass (waiters still blocked elsewhere just leave it)
+            // and the descriptor is freed, so the semaphore goes up by the units the waiters were waiting for
+            *semAddr = prevSemVal + removeBlockedAll(semAddr, semstatqueue(&released));
+            semstatrelease(&released);
+        }
+        // Take a mutex, which may block the caller the same way a P does
+        else if (op == MLOCK) {
+            int locked = lockMutex(semAddr, callingProcess);
+            if (locked == ENULL || locked == ENOSEMD) {
+                reportStatus = TRUE;
+                status = MIN(status, locked == ENULL ? -1 : ENOSEMD);
+                applied = FALSE;
+            }
+            callingProcessBlocked = callingProcessBlocked || locked == FALSE;
+            if (locked == FALSE && semWatchCount > 0 && semstatblock(semAddr) && watchedSem == (int*)ENULL) {
+                watchedSem = semAddr;
+            }
+        }
+        // Give up a mutex held by the caller
+        else if (op == MUNLOCK) {
+            mutex_t* mutex = findMutex(semAddr);
+            if (mutex != (mutex_t*)ENULL && mutex->m_owner == callingProcess) {
+                unlockMutex(mutex);
             }
             else {
-                // Do nothing if the semaphore was not active, indicative of available resources
+                reportStatus = TRUE;
+                status = MIN(status, -1);
+                applied = FALSE;
             }
         }
+        // Any other op (0) leaves the semaphore alone
+        else {
+            applied = FALSE;
+        }
+
+        // Skipped any-P's and undone P's left the loop early, so only the ops that took effect are counted
+        if (applied && semWatchCount > 0) {
+            semstatop(semAddr, op < 0 || op == MLOCK);
+        }
     }
 
-    // Ensure atomic operation, even if calling process was blocked
-    if (callingProcessBlocked) {
+    // Hand back the index of the any-P that fired, or ENULL while the caller still waits for one
+    if (anyWait) {
+        SYS_TRAP_OLD_STATE->s_r[3] = callingProcess->p_cold->p_s.s_r[3];
+        if (SYS_TRAP_OLD_STATE->s_r[3] == ENULL && !anyBlocked) {
+            reportStatus = TRUE;
+            status = MIN(status, -1);
+        }
+    }
+
+    // A blocked caller finds its status in its saved state once it runs again (a timeout overwrites it)
+    if (reportStatus) {
+        SYS_TRAP_OLD_STATE->s_r[2] = status;
+    }
+
+    // Ensure atomic operation, even if calling process was blocked. A V later in the vector may
+    // already have released the caller, in which case it is on the RQ alone and keeps running
+    if (callingProcessBlocked && callingProcess->qcount > 1) {
         removeProc(&readyQueue);
+        callingProcess->p_cold->p_s = *SYS_TRAP_OLD_STATE;
+        semstatwait(callingProcess, watchedSem);
+
+        // The clock interrupt gives up on a timed P once its deadline passes
+        if (timedWait) {
+            settimedwait(callingProcess, timeout);
+        }
         schedule();
     }
 }
 
 
 /*
-    If this instruction is executed, it should should result in an error condition. Your
-    nucleus should halt if this instruction is executed.
+    Fast path of SYS3 for a vector of a single plain P or V (no flags, not VALL or a mutex op), which is
+    what nearly every caller passes. trapsyshandler tries it before its time accounting: the process's
+    state is only saved if the P blocks, and otherwise it goes straight back to the caller with LDST.
+    Return FALSE, having changed nothing, if the vpop needs the general semop() (or a semaphore is
+    watched, see SEMWATCH), and TRUE once it has been done.
+*/
+int semopfast()
+{
+    state_t* SYS_TRAP_OLD_STATE = (state_t*)0x930;
+    vpop* semOperation = (vpop*)SYS_TRAP_OLD_STATE->s_r[4];
+    int op = semOperation->op;
+    int* semAddr = semOperation->sem;
+
+    if (op <= -PANY || op == 0 || op >= VALL || semWatchCount > 0) {
+        return FALSE;
+    }
+
+    int prevSemVal = *semAddr;
+    *semAddr = prevSemVal + op;
+
+    // A V releases the waiters whose units are now there, a P that has its units is done
+    if (op > 0) {
+        releaseBlocked(semAddr, &readyQueue);
+        return TRUE;
+    }
+    if (prevSemVal >= -op) {
+        return TRUE;
+    }
+
+    // The P blocks: same as semop(), including giving the P back when no descriptor is free
+    proc_t* callingProcess = headQueue(readyQueue);
+    if (insertBlockedN(semAddr, callingProcess, -op)) {
+        *semAddr = prevSemVal;
+        SYS_TRAP_OLD_STATE->s_r[2] = ENOSEMD;
+        return TRUE;
+    }
+
+    // Only now is the time on the CPU accounted for and the state saved
+    removeProc(&readyQueue);
+    updateTotalTimeOnProcessor(callingProcess);
+    callingProcess->p_cold->p_s = *SYS_TRAP_OLD_STATE;
+    callingProcess->p_cold->waiting_mutex = (int*)ENULL;
+    schedule();
+    return TRUE;
+}
+
+
+/*
+    Mark every entry of the mutex table as unused (no mutex is held).
+*/
+void mutexinit()
+{
+    int i;
+    for (i = 0; i < MAXMUTEX; i++) {
+        mutexTable[i].m_addr = (int*)ENULL;
+        mutexTable[i].m_owner = (proc_t*)ENULL;
+    }
+}
+
+
+/*
+    Return the entry of the mutex table for the mutex word at mutexAddr (ENULL for a free entry),
+    or ENULL if there is none.
+*/
+mutex_t* findMutex(int* mutexAddr)
+{
+    int i;
+    for (i = 0; i < MAXMUTEX; i++) {
+        if (mutexTable[i].m_addr == mutexAddr) {
+            return &mutexTable[i];
+        }
+    }
+    return (mutex_t*)ENULL;
+}
+
+
+/*
+    Take the mutex whose word is at mutexAddr for process. Return TRUE if it is now held by process,
+    FALSE if process was blocked waiting for it, ENOSEMD if it had to block but no semaphore descriptor
+    was free, and ENULL if it cannot be taken.
 */
-void notused() {
-    HALT();
+int lockMutex(int* mutexAddr, proc_t* process)
+{
+    mutex_t* mutex = findMutex(mutexAddr);
+
+    // A free mutex becomes the caller's, and whoever waits for it from now on queues by priority
+    if (mutex == (mutex_t*)ENULL && *mutexAddr == 1) {
+        mutex = findMutex((int*)ENULL);
+        if (mutex == (mutex_t*)ENULL || setSemaphorePolicy(mutexAddr, SEMPRIORITY)) {
+            return ENULL;
+        }
+        mutex->m_addr = mutexAddr;
+        mutex->m_owner = process;
+        *mutexAddr = 0;
+        return TRUE;
+    }
+
+    // Only a mutex held by another process can be waited for
+    if (mutex == (mutex_t*)ENULL || mutex->m_owner == process) {
+        return ENULL;
+    }
+
+    // Block on the word like a P, so a kill or timeout gives the unit back the usual way
+    *mutexAddr -= 1;
+    if (insertBlocked(mutexAddr, process)) {
+        *mutexAddr += 1;
+        return ENOSEMD;
+    }
+
+    // The holder (and whoever it waits for in turn) runs at the waiter's priority until it unlocks
+    process->p_cold->waiting_mutex = mutexAddr;
+    inheritPriority(mutex->m_owner, process);
+    return FALSE;
+}
+
+
+/*
+    Give up the mutex. Its most urgent waiter is released and holds it from now on, otherwise the
+    mutex is free again (its word back to 1). The old holder drops the priority it inherited from it.
+*/
+void unlockMutex(mutex_t* mutex)
+{
+    proc_t* owner = mutex->m_owner;
+    int* mutexAddr = mutex->m_addr;
+    proc_t* nextOwner = headBlocked(mutexAddr);
+
+    *mutexAddr += 1;
+    if (nextOwner == (proc_t*)ENULL) {
+        mutex->m_addr = (int*)ENULL;
+        mutex->m_owner = (proc_t*)ENULL;
+        setSemaphorePolicy(mutexAddr, SEMFIFO);
+    }
+    else {
+        // The unit given back is exactly the one the head waits for; it goes to the RQ unless still blocked elsewhere
+        proc_link released;
+        releaseBlocked(mutexAddr, semstatqueue(&released));
+        semstatrelease(&released);
+        mutex->m_owner = nextOwner;
+        nextOwner->p_cold->waiting_mutex = (int*)ENULL;
+        restorePriority(nextOwner);
+    }
+    restorePriority(owner);
+}
+
+
+/*
+    Raise the priority of the holder of a mutex to that of waiter, and follow the mutexes the holders
+    in turn are blocked on (at most MAXMUTEX of them, so a deadlocked cycle ends) doing the same.
+    A holder whose priority is raised also runs with the waiter's stride tickets if it has fewer.
+*/
+void inheritPriority(proc_t* owner, proc_t* waiter)
+{
+    int steps;
+    for (steps = 0; steps < MAXMUTEX && owner->p_priority < waiter->p_priority; steps++) {
+        owner->p_priority = waiter->p_priority;
+        if (owner->p_tickets < waiter->p_tickets) {
+            stridetickets(owner, waiter->p_tickets);
+        }
+
+        // A runnable holder moves up the RQ (the waiter at its head has this priority, so the holder lands behind it)
+        // and to the top MLFQ level until restorePriority(), so it is not left waiting behind the processes of a higher level
+        if (outReady(owner) != (proc_t*)ENULL) {
+            if (owner->p_cold->base_level == ENULL) {
+                owner->p_cold->base_level = owner->p_level;
+            }
+            owner->p_level = 0;
+            insertProcPriority(&readyQueue, owner);
+            return;
+        }
+
+        // Otherwise it only passes the priority on if all it waits for is another mutex
+        int* mutexAddr = owner->p_cold->waiting_mutex;
+        if (mutexAddr == (int*)ENULL || owner->qcount != 1) {
+            return;
+        }
+        mutex_t* mutex = findMutex(mutexAddr);
+        if (mutex == (mutex_t*)ENULL) {
+            return;
+        }
+
+        // Move it up that mutex's queue for its new priority. It keeps its link node there, so nothing
+        // has to be allocated; should it not be on the queue after all, the chain stops here
+        if (requeueBlocked(mutexAddr, owner)) {
+            return;
+        }
+        owner = mutex->m_owner;
+    }
+}
+
+
+/*
+    Set the priority and stride tickets of process back to the ones it was given, or to those of the
+    most urgent waiters on the mutexes it still holds if higher. Once it inherits no priority it goes
+    back to the MLFQ level it had before it first did.
+*/
+void restorePriority(proc_t* process)
+{
+    int priority = process->p_cold->base_priority;
+    int tickets = process->p_cold->base_tickets;
+
+    int i;
+    for (i = 0; i < MAXMUTEX; i++) {
+        if (mutexTable[i].m_addr != (int*)ENULL && mutexTable[i].m_owner == process) {
+            // Mutex waiters queue by priority, so the head is the most urgent
+            proc_t* waiter = headBlocked(mutexTable[i].m_addr);
+            if (waiter != (proc_t*)ENULL && waiter->p_priority > process->p_cold->base_priority) {
+                priority = MAX(priority, waiter->p_priority);
+                tickets = MAX(tickets, waiter->p_tickets);
+            }
+        }
+    }
+    process->p_priority = priority;
+    if (process->p_tickets != tickets) {
+        stridetickets(process, tickets);
+    }
+
+    int level = process->p_cold->base_level;
+    if (priority == process->p_cold->base_priority && level != ENULL) {
+        // A process waiting on an MLFQ level moves to its old one, otherwise schedule() places it by p_level
+        process->p_cold->base_level = ENULL;
+        if (outProc(&levelQueue[process->p_level], process) != (proc_t*)ENULL) {
+            insertProc(&levelQueue[level], process);
+        }
+        process->p_level = level;
+    }
+}
+
+
+/*
+    Start keeping the statistics of the semaphore at semAddr from zero (see SEMWATCH). Return FALSE,
+    or TRUE if SEMWATCHES other semaphores are already being watched.
+*/
+int semstatwatch(int* semAddr)
+{
+    semstat* stat = findsemstat(semAddr);
+    if (stat == (semstat*)ENULL) {
+        if (semWatchCount == SEMWATCHES) {
+            return TRUE;
+        }
+        stat = &semWatches[semWatchCount++];
+    }
+
+    stat->sem = semAddr;
+    stat->ps = 0;
+    stat->vs = 0;
+    stat->blocked = 0;
+    stat->peak = 0;
+    stat->wait_total = 0;
+    stat->wait_max = 0;
+    return FALSE;
+}
+
+
+/*
+    Return the statistics kept for the semaphore at semAddr, or ENULL if it is not watched.
+*/
+semstat* findsemstat(int* semAddr)
+{
+    int i;
+    for (i = 0; i < semWatchCount; i++) {
+        if (semWatches[i].sem == semAddr) {
+            return &semWatches[i];
+        }
+    }
+    return (semstat*)ENULL;
+}
+
+
+/*
+    Count a P (isP TRUE) or a V applied to the semaphore at semAddr, if it is watched. Callers check
+    semWatchCount first, so nothing is looked up while no semaphore is watched.
+*/
+void semstatop(int* semAddr, int isP)
+{
+    semstat* stat = findsemstat(semAddr);
+    if (stat != (semstat*)ENULL) {
+        if (isP) {
+            stat->ps++;
+        }
+        else {
+            stat->vs++;
+        }
+    }
+}
+
+
+/*
+    Count a P that has just blocked on the semaphore at semAddr, if it is watched, and update the
+    most processes blocked on it at once. Return TRUE if the semaphore is watched.
+*/
+int semstatblock(int* semAddr)
+{
+    semstat* stat = findsemstat(semAddr);
+    if (stat == (semstat*)ENULL) {
+        return FALSE;
+    }
+
+    stat->blocked++;
+    stat->peak = MAX(stat->peak, countBlocked(semAddr));
+    return TRUE;
+}
+
+
+/*
+    Start timing the wait of a process that is coming off the RQ, charged to the watched semaphore
+    at semAddr (ENULL if none of the semaphores it blocked on is watched).
+*/
+void semstatwait(proc_t* process, int* semAddr)
+{
+    process->p_cold->wait_sem = semAddr;
+    if (semAddr != (int*)ENULL) {
+        STCK(&process->p_cold->wait_start);
+    }
+}
+
+
+/*
+    Return the queue that the processes a V, interrupt or timeout is about to release should go on:
+    released (emptied here) while a semaphore is watched, so semstatrelease sees exactly those
+    processes, and the RQ otherwise.
+*/
+proc_link* semstatqueue(proc_link* released)
+{
+    released->next = (proc_t*)ENULL;
+    released->index = ENULL;
+    return (semWatchCount > 0) ? released : &readyQueue;
+}
+
+
+/*
+    End the waits of the processes on released (see semstatqueue) and move them, in the order they
+    were released, to the tail of the RQ.
+*/
+void semstatrelease(proc_link* released)
+{
+    if (released->next == (proc_t*)ENULL) {
+        return;
+    }
+
+    long currentTime;
+    STCK(&currentTime);
+
+    proc_t* process = headQueue(*released);
+    while (process != (proc_t*)ENULL) {
+        if (process->p_cold->wait_sem != (int*)ENULL) {
+            semstat* stat = findsemstat(process->p_cold->wait_sem);
+            if (stat != (semstat*)ENULL) {
+                long waited = currentTime - process->p_cold->wait_start;
+                stat->wait_total += waited;
+                stat->wait_max = MAX(stat->wait_max, waited);
+            }
+            process->p_cold->wait_sem = (int*)ENULL;
+        }
+        process = nextProc(released, process);
+    }
+    spliceProc(released, &readyQueue);
+}
+
+
+/*
+    This instruction used to be unused, and executing it halted the nucleus. It now carries the
+    nucleus settings that have no SYS of their own, selected by the function code in D2 (see const.h).
+    Any other code is still an error condition and halts the nucleus.
+
+    - SETPRIORITY: D4 becomes the priority of the calling process. Higher is more urgent; the
+      processes it creates from now on start with the same priority. While it holds a mutex with
+      a more urgent waiter it keeps running at the waiter's priority.
+    - SEMPOLICY: the semaphore whose address is in D3 queues its waiters in the order given in D4,
+      SEMFIFO or SEMPRIORITY. D2 is -1 on return if SEMPOLICIES semaphores already have a
+      policy other than FIFO, and 0 otherwise.
+    - SEMWATCH: the nucleus starts keeping contention statistics (a semstat, see vpop.h) for the
+      semaphore whose address is in D3, from zero if it already was. D2 is -1 on return if
+      SEMWATCHES semaphores are already watched, and 0 otherwise.
+    - SEMSTATS: the statistics of the semaphore whose address is in D3 are copied to the semstat
+      whose address is in D4. D2 is -1 on return if the semaphore is not watched, and 0 otherwise.
+    - SETQUANTUM: D4 (microseconds) becomes the time slice of the calling process from its next
+      dispatch on, and that of the processes it creates from now on. If D3 is TRUE its descendants
+      get it too. D2 is -1 on return (and nothing changes) if D4 is not positive, and 0 otherwise.
+    - SETSCHED: D4 becomes the scheduling policy of the nucleus, SCHEDMLFQ or SCHEDSTRIDE (see
+      schedule() in main.c). D2 is -1 on return if D4 is neither, and 0 otherwise.
+    - SETTICKETS: D4 becomes the number of stride tickets of the calling process and of the
+      processes it creates from now on. D2 is -1 on return (and nothing changes) if D4 is not
+      positive, and 0 otherwise.
+*/
+void nucleusctl()
+{
+    // The interrupted process's state is saved in old_state (SYS)
+    state_t* SYS_TRAP_OLD_STATE = (state_t*)0x930;
+
+    // Grab the interrupted process
+    proc_t* process = headQueue(readyQueue);
+
+    switch (SYS_TRAP_OLD_STATE->s_r[2]) {
+        case (SETPRIORITY):
+            // Any priority inherited from waiters on its mutexes still applies on top
+            process->p_cold->base_priority = SYS_TRAP_OLD_STATE->s_r[4];
+            restorePriority(process);
+            break;
+        case (SEMPOLICY):
+            SYS_TRAP_OLD_STATE->s_r[2] = setSemaphorePolicy((int*)SYS_TRAP_OLD_STATE->s_r[3], SYS_TRAP_OLD_STATE->s_r[4]) ? -1 : 0;
+            break;
+        case (SEMWATCH):
+            SYS_TRAP_OLD_STATE->s_r[2] = semstatwatch((int*)SYS_TRAP_OLD_STATE->s_r[3]) ? -1 : 0;
+            break;
+        case (SETQUANTUM):
+            if (SYS_TRAP_OLD_STATE->s_r[4] <= 0) {
+                SYS_TRAP_OLD_STATE->s_r[2] = -1;
+                break;
+            }
+            process->p_quantum = SYS_TRAP_OLD_STATE->s_r[4];
+            if (SYS_TRAP_OLD_STATE->s_r[3]) {
+                setquantumrecurse(process->p_cold->children_proc, process->p_quantum);
+            }
+            SYS_TRAP_OLD_STATE->s_r[2] = 0;
+            break;
+        case (SETSCHED):
+            SYS_TRAP_OLD_STATE->s_r[2] = setschedpolicy(SYS_TRAP_OLD_STATE->s_r[4]) ? -1 : 0;
+            break;
+        case (SETTICKETS):
+            if (SYS_TRAP_OLD_STATE->s_r[4] <= 0) {
+                SYS_TRAP_OLD_STATE->s_r[2] = -1;
+                break;
+            }
+            // Any tickets inherited from waiters on its mutexes still apply on top
+            process->p_cold->base_tickets = SYS_TRAP_OLD_STATE->s_r[4];
+            restorePriority(process);
+            SYS_TRAP_OLD_STATE->s_r[2] = 0;
+            break;
+        case (SEMSTATS): {
+            semstat* stat = findsemstat((int*)SYS_TRAP_OLD_STATE->s_r[3]);
+            if (stat != (semstat*)ENULL) {
+                *(semstat*)SYS_TRAP_OLD_STATE->s_r[4] = *stat;
+            }
+            SYS_TRAP_OLD_STATE->s_r[2] = (stat == (semstat*)ENULL) ? -1 : 0;
+            break;
+        }
+        default:
+            HALT();
+    }
+}
+
+
+/*
+    Give process, its siblings after it and all their descendants the time slice quantum.
+*/
+void setquantumrecurse(proc_t* process, long quantum)
+{
+    while (process != (proc_t*)ENULL) {
+        process->p_quantum = quantum;
+        setquantumrecurse(process->p_cold->children_proc, quantum);
+        process = process->p_cold->sibling_proc;
+    }
 }
 
 
@@ -254,9 +914,9 @@ void trapstate()
     switch (trapType) {
         case (PROGTRAP):
             // We can only specify the trap state vector once per trap type
-            if (process->prog_trap_old_state == (state_t*)ENULL && process->prog_trap_new_state == (state_t*)ENULL) {
-                process->prog_trap_old_state = old_state_area;
-                process->prog_trap_new_state = new_state_area;
+            if (process->p_cold->prog_trap_old_state == (state_t*)ENULL && process->p_cold->prog_trap_new_state == (state_t*)ENULL) {
+                process->p_cold->prog_trap_old_state = old_state_area;
+                process->p_cold->prog_trap_new_state = new_state_area;
                 break;
             }
             else {
@@ -264,9 +924,9 @@ void trapstate()
             }
         case (MMTRAP):
             // We can only specify the trap state vector once per trap type
-            if (process->mm_trap_old_state == (state_t*)ENULL && process->mm_trap_new_state == (state_t*)ENULL) {
-                process->mm_trap_old_state = old_state_area;
-                process->mm_trap_new_state = new_state_area;
+            if (process->p_cold->mm_trap_old_state == (state_t*)ENULL && process->p_cold->mm_trap_new_state == (state_t*)ENULL) {
+                process->p_cold->mm_trap_old_state = old_state_area;
+                process->p_cold->mm_trap_new_state = new_state_area;
                 break;
             } 
             else {
@@ -274,9 +934,9 @@ void trapstate()
             }
         case (SYSTRAP):
             // We can only specify the trap state vector once per trap type
-            if (process->sys_trap_old_state == (state_t*)ENULL && process->sys_trap_new_state == (state_t*)ENULL) {
-                process->sys_trap_old_state = old_state_area;
-                process->sys_trap_new_state = new_state_area;
+            if (process->p_cold->sys_trap_old_state == (state_t*)ENULL && process->p_cold->sys_trap_new_state == (state_t*)ENULL) {
+                process->p_cold->sys_trap_old_state = old_state_area;
+                process->p_cold->sys_trap_new_state = new_state_area;
                 break;
             } 
             else {
@@ -314,15 +974,15 @@ void trapsysdefault()
     proc_t* process = headQueue(readyQueue);
 
     // The process's old state area has been initialized and the appropiate new sys handler is present in the process's new sys area
-    if (process->sys_trap_old_state != (state_t*)ENULL && process->sys_trap_new_state != (state_t*)ENULL) {
+    if (process->p_cold->sys_trap_old_state != (state_t*)ENULL && process->p_cold->sys_trap_new_state != (state_t*)ENULL) {
         // Update process start time as we load sys trap handler on CPU
         updateLastStartTime(process);
 
         // Copy the interrupted process state (stored in 0x930) into the process's SYS Trap Old State Area
-        *process->sys_trap_old_state = *SYS_TRAP_OLD_STATE;
+        *process->p_cold->sys_trap_old_state = *SYS_TRAP_OLD_STATE;
 
         // Load the Handler State routine specifics stored in this process's SYS New State struct ptr (address set in SYS5) onto the CPU
-        LDST(process->sys_trap_new_state);
+        LDST(process->p_cold->sys_trap_new_state);
     }
     else {
         // No handler address in the PTE for this trap or area to store its previous state
@@ -35,6 +35,7 @@
 /* Device related registers and semaphores */
 extern int MEMSTART;
 extern proc_link readyQueue;
+extern int schedPolicy;
 
 /* Trap Area States */
 state_t* PROG_TRAP_OLD_STATE;
@@ -50,6 +51,9 @@ void static trapproghandler();
 void updateTotalTimeOnProcessor(proc_t* p);
 void updateLastStartTime(proc_t* p);
 
+/* Single P or V fast path of SYS3 (syscall.c) */
+extern int semopfast();
+
 
 /*
     When a trap/exception occurs, the hardware auto-saves the interrupted process state to
@@ -62,6 +66,15 @@ void updateLastStartTime(proc_t* p);
 */
 void static trapsyshandler() 
 {
+    // A SYS3 of one plain P or V is done before the time accounting, the few microseconds stay charged
+    // to the caller. Its state is only saved if it blocks, and otherwise it is reloaded straight away
+#ifndef NOSEMOPFAST
+    if (SYS_TRAP_OLD_STATE->s_tmp.tmp_sys.sys_no == 3 && SYS_TRAP_OLD_STATE->s_sr.ps_s == 1 && SYS_TRAP_OLD_STATE->s_r[3] == 1 && semopfast()) {
+        intcheckslice();
+        LDST(SYS_TRAP_OLD_STATE);
+    }
+#endif
+
     // Grab the interrupted process from the RQ
     proc_t* process = headQueue(readyQueue);
     updateTotalTimeOnProcessor(process);
@@ -72,15 +85,15 @@ void static trapsyshandler()
         SYS_TRAP_OLD_STATE->s_tmp.tmp_pr.pr_typ = PRIVILEGE;
 
         // The process's old state area has been initialized and the appropiate new prog handler is present in the process's new prog area
-        if (process->prog_trap_new_state != (state_t*)ENULL && process->prog_trap_old_state != (state_t*)ENULL) {
+        if (process->p_cold->prog_trap_new_state != (state_t*)ENULL && process->p_cold->prog_trap_old_state != (state_t*)ENULL) {
             // Update process start time as we load it unto the CPU
             updateLastStartTime(process);
 
             // Copy the interrupted process state (stored in 0x800) into the process's Prog Trap Old State Area
-            *process->prog_trap_old_state = *SYS_TRAP_OLD_STATE;
+            *process->p_cold->prog_trap_old_state = *SYS_TRAP_OLD_STATE;
 
             // Load the Handler State routine specifics stored in this process's New State struct ptr (address set in SYS5) onto the CPU
-            LDST(process->prog_trap_new_state);
+            LDST(process->p_cold->prog_trap_new_state);
         } 
         else {
             // No handler address the PTE for this trap or area to store its previous state
@@ -97,10 +110,10 @@ void static trapsyshandler()
             killproc();         // Invokes schedule, no need to save state of this process
             break;
         case (3):
-            semop();            // May invoke schedule, saves the process->p_s when added to blocked queue
+            semop();            // May invoke schedule, saves the process->p_cold->p_s when added to blocked queue
             break;
         case (4):
-            notused();
+            nucleusctl();       // LDST loads the state of this process right before the interrupt/trap, or halts
             break;
         case (5):
             trapstate();        // LDST loads the state of this process right before the interrupt/trap or kills process
@@ -109,17 +122,18 @@ void static trapsyshandler()
             getcputime();       // LDST loads the state of this process right before the interrupt/trap
             break;
         case (7):
-            waitforpclock();    // May invoke schedule, saves the process->p_s on LOCK operation
+            waitforpclock();    // May invoke schedule, saves the process->p_cold->p_s on LOCK operation
             break;
         case (8):
-            waitforio();        // May invoke schedule, saves the process->p_s on LOCK operation
+            waitforio();        // May invoke schedule, saves the process->p_cold->p_s on LOCK operation
             break;
         default:
             trapsysdefault();   // LDST loads the sys trap handler from the new area state
             break;
     }
 
-    // Reload the interrupted process on the CPU
+    // Reload the interrupted process on the CPU, with the end of its time slice timed if it made another process ready
+    intcheckslice();
     updateLastStartTime(process);
     LDST(SYS_TRAP_OLD_STATE);
 }
@@ -134,15 +148,15 @@ void static trapmmhandler()
     proc_t* process = headQueue(readyQueue);
 
     // The process's old state area has been initialized and the appropiate new mm handler is present in the process's new mm area
-    if (process->mm_trap_new_state != (state_t*)ENULL && process->mm_trap_old_state != (state_t*)ENULL) {
+    if (process->p_cold->mm_trap_new_state != (state_t*)ENULL && process->p_cold->mm_trap_old_state != (state_t*)ENULL) {
         // Update process start time as we load it unto the CPU
         updateLastStartTime(process);
 
         // Copy the interrupted process state
-        *process->mm_trap_old_state = *MM_TRAP_OLD_STATE;
+        *process->p_cold->mm_trap_old_state = *MM_TRAP_OLD_STATE;
 
         // Load the Handler State routine specifics stored in this process's New State struct ptr (address set in SYS5) onto the CPU
-        LDST(process->mm_trap_new_state);
+        LDST(process->p_cold->mm_trap_new_state);
     }
     else {
         // No handler address in the PTE for this trap or area to store its previous state
@@ -160,15 +174,15 @@ void static trapproghandler()
     proc_t* process = headQueue(readyQueue);
 
     // The process's old state area has been initialized and the appropiate new prog handler is present in the process's new prog area
-    if (process->prog_trap_new_state != (state_t*)ENULL && process->prog_trap_old_state != (state_t*)ENULL) {
+    if (process->p_cold->prog_trap_new_state != (state_t*)ENULL && process->p_cold->prog_trap_old_state != (state_t*)ENULL) {
         // Update process start time as we load it unto the CPU
         updateLastStartTime(process);
 
         // Copy the interrupted process state (stored in 0x800) into the process's Prog Trap Old State Area
-        *process->prog_trap_old_state = *PROG_TRAP_OLD_STATE;
+        *process->p_cold->prog_trap_old_state = *PROG_TRAP_OLD_STATE;
 
         // Load the Handler State routine specifics stored in this process's New State struct ptr (address set in SYS5) onto the CPU
-        LDST(process->prog_trap_new_state);
+        LDST(process->p_cold->prog_trap_new_state);
     } 
     else {
         // No handler address in the PTE for this trap or area to store its previous state
@@ -193,6 +207,7 @@ void updateLastStartTime(proc_t* process)
 /*
     When the kernel removes the current prcoess from the RQ, so we use this to recalculate the
     total amount of time the removed process was on the CPU by adding the current time slice.
+    Under stride scheduling the same time also advances the process's pass (see schedule() in main.c).
 */
 void updateTotalTimeOnProcessor(proc_t* process) 
 {
@@ -201,6 +216,10 @@ void updateTotalTimeOnProcessor(proc_t* process)
     STCK(&currentTime);
     long prevTimeSlice = currentTime - process->last_start_time;
     process->total_processor_time += prevTimeSlice;
+
+    if (schedPolicy == SCHEDSTRIDE) {
+        process->p_pass += prevTimeSlice * STRIDE1 / process->p_tickets;
+    }
 }
 
 
@@ -7,19 +7,67 @@
 #include "../h/procq.e"
 #include "../h/asl.e"
 
-semd_t semdTable[MAXPROC];		            /* All semaphore entries are placed in this table */
+/* Most descriptors there can ever be: the static table plus the ones carved at boot */
+#define SEMDTOTAL (MAXSEMD + EXTRASEMD)
+
+/* Size of the ASL hash index, a power of two at least twice the number of descriptors */
+#ifndef SEMDHASH
+#if SEMDTOTAL <= 32
+#define SEMDHASH 64
+#elif SEMDTOTAL <= 128
+#define SEMDHASH 256
+#elif SEMDTOTAL <= 512
+#define SEMDHASH 1024
+#elif SEMDTOTAL <= 2048
+#define SEMDHASH 4096
+#elif SEMDTOTAL <= 8192
+#define SEMDHASH 16384
+#else
+#define SEMDHASH 65536
+#endif
+#endif
+
+#if SEMDHASH < 2 * SEMDTOTAL || (SEMDHASH & (SEMDHASH - 1)) != 0
+#error "SEMDHASH must be a power of two and at least twice MAXSEMD + EXTRASEMD"
+#endif
+
+semd_t semdTable[MAXSEMD];		            /* All semaphore entries are placed in this table */
+semd_t* semdHash[SEMDHASH];		            /* Open addressing index of the ASL keyed by s_semAdd */
 semd_t* semdFree_h = (semd_t*)ENULL;	    /* List of inactive semaphores */
 semd_t* semd_h = (semd_t*)ENULL;	        /* Pointer to the head of the ASL */
+int semdCount = 0;                          /* Descriptors owned by the ASL: semdTable plus any extension */
+int* prioritySemaphores[SEMPOLICIES];       /* Semaphores whose waiters are queued by priority */
+int prioritySemaphoreCount = 0;
+int semLinkCount = 0;                       /* Link nodes holding processes on semaphore queues, at most SEMLINKS */
+int semdSorted = TRUE;                      /* FALSE once a descriptor pushed on the ASL breaks its address order */
+
+extern link_t linkPool[];                   /* Queue link nodes, see procq.c */
+
+#ifdef BENCH
+long semdProbes = 0;                        /* Descriptors examined by ASL lookups (benchmark builds only) */
+#define COUNT_PROBE() semdProbes++
+#else
+#define COUNT_PROBE()
+#endif
 
 /* Local Utility Routines */
 void returnSemaphoreToFreeList(semd_t* s);
 void removeSemaphoreFromActiveList(semd_t* s);
 void insertSemaphoreIntoActiveList(semd_t* s);
-void addSemaphoreToProcessVector(int* semAddr, proc_t* p);
+void sortActiveList();
 semd_t* allocateSemaphoreFromFreeList();
 semd_t* getSemaphoreFromActiveList(int* semAddr);
 void resetSemaphore(semd_t* s);
-void removeSemaphoreFromProcessVector(int* semAddr, proc_t* p);
+void recordSemaphoreInProcessLink(semd_t* s, proc_t* p, int units, int any);
+semd_t* semaphoreOfLink(int idx);
+int releaseSatisfiedWaiters(semd_t* s, proc_link* tp);
+proc_t* releaseHead(semd_t* s, proc_link* tp);
+int detachProcess(proc_t* p, int anyOnly, semd_t* detached[]);
+void settleSemaphores(semd_t* detached[], int n, proc_link* tp);
+int hashSemaphoreAddress(int* semAddr);
+void insertSemaphoreIntoHashIndex(semd_t* s);
+void removeSemaphoreFromHashIndex(semd_t* s);
+int findPrioritySemaphore(int* semAddr);
 
 
 /*
@@ -27,10 +75,32 @@ void removeSemaphoreFromProcessVector(int* semAddr, proc_t* p);
     with the semaphore whose address is semAdd. If the semaphore is currently not
     active (there is no descriptor for it in the ASL), allocate a new descriptor from the
     free list, insert it in the ASL (at the appropriate position), and initialize all of the
-    fields. If a new semaphore descriptor needs to be allocated and the free list is empty,
-    return TRUE. In all other cases return FALSE.
+    fields. If a new semaphore descriptor needs to be allocated and the free list is empty, or
+    no link node is left for semaphore queues (SEMLINKS), return TRUE. In all other cases return FALSE.
 */
 int insertBlocked(int* semAddr, proc_t* p)
+{
+    // A plain P waits for a single unit
+    return insertBlockedN(semAddr, p, 1);
+}
+
+
+/*
+    Same as insertBlocked, for a process waiting for the given number (at least 1) of units of the
+    semaphore. The units are recorded with the process's link so releaseBlocked knows when it can go.
+*/
+int insertBlockedN(int* semAddr, proc_t* p, int units)
+{
+    return insertBlockedAny(semAddr, p, units, ENULL);
+}
+
+
+/*
+    Same as insertBlockedN, for a P of a wait-any. any is the index of the P in its vpop vector
+    (ENULL for a plain P). Once one P of the wait-any gets its units, p is taken off the queues
+    of the others and the index of that P is left in D3 of p's saved state.
+*/
+int insertBlockedAny(int* semAddr, proc_t* p, int units, int any)
 {
     // ASL is double linked list where each entry contains a pointer to 
     // a circular queue of processes blocked by the semaphore of that entry
@@ -40,12 +110,25 @@ int insertBlocked(int* semAddr, proc_t* p)
     if (semaphoreDescriptor == (semd_t*)ENULL && semdFree_h == (semd_t*)ENULL) {
         return TRUE;
     }
+    // Semaphore queues already hold all the link nodes they may, the rest are kept for the process queues
+    else if (semLinkCount == SEMLINKS) {
+        return TRUE;
+    }
     else {
         // An Entry in the ASL is present for this semaphore
         if (semaphoreDescriptor != (semd_t*)ENULL) {
-            // Add the process to the tail of the Semaphore's proc queue and the semaphore to the proc's semaphore vector list
-            addSemaphoreToProcessVector(semAddr, p);
-            insertProc(&semaphoreDescriptor->s_link, p);
+            // Add the process to the Semaphore's proc queue in the semaphore's order and record the semaphore in the proc's link
+            int noLink;
+            if (semaphoreDescriptor->s_policy == SEMPRIORITY) {
+                noLink = insertProcPriority(&semaphoreDescriptor->s_link, p);
+            }
+            else {
+                noLink = insertProc(&semaphoreDescriptor->s_link, p);
+            }
+            if (noLink) {
+                return TRUE;
+            }
+            recordSemaphoreInProcessLink(semaphoreDescriptor, p, units, any);
             return FALSE;
         }
         // Otherwise there are inactive/free semaphores with no associated process queues that we can add to the ASL:
@@ -53,10 +136,16 @@ int insertBlocked(int* semAddr, proc_t* p)
             // Allocate a semaphore descriptor from the free list 
             semd_t* newDescriptor = allocateSemaphoreFromFreeList();
             newDescriptor->s_semAdd = semAddr;
+            if (prioritySemaphoreCount > 0 && findPrioritySemaphore(semAddr) != ENULL) {
+                newDescriptor->s_policy = SEMPRIORITY;
+            }
 
-            // Add the process to the tail of the Semaphore's proc queue and the semaphore to the proc's semaphore vector list
-            addSemaphoreToProcessVector(semAddr, p);
-            insertProc(&newDescriptor->s_link, p);
+            // Add the process to the tail of the Semaphore's proc queue and record the semaphore in the proc's link
+            if (insertProc(&newDescriptor->s_link, p)) {
+                returnSemaphoreToFreeList(newDescriptor);
+                return TRUE;
+            }
+            recordSemaphoreInProcessLink(newDescriptor, p, units, any);
 
             // Add this semaphore to the ASL
             insertSemaphoreIntoActiveList(newDescriptor);
@@ -71,6 +160,7 @@ int insertBlocked(int* semAddr, proc_t* p)
     Otherwise, remove THE FIRST process table entry from the process queue of the appropriate 
     semaphore descriptor and return a pointer to it. If the process queue for this semaphore becomes empty,
     remove the descriptor from the ASL and insert it in the free list of semaphore descriptors.
+    A process in a wait-any also leaves its other semaphores, which get its units back as by outBlocked.
 */
 proc_t* removeBlocked(int* semAddr)
 {
@@ -81,8 +171,9 @@ proc_t* removeBlocked(int* semAddr)
         return (proc_t*)ENULL;
     }
 
-    // Remove the first proc from the process queue of the ASL semaphore
-    proc_t* process = removeProc(&semaphoreDescriptor->s_link);
+    // Remove the first proc from the process queue of the ASL semaphore, which also releases its link,
+    // and stop counting the units it was waiting for
+    proc_t* process = releaseHead(semaphoreDescriptor, (proc_link*)ENULL);
 
     // Check if the associated process queue is now empty
     if (semaphoreDescriptor->s_link.next == (proc_t*)ENULL) {
@@ -90,51 +181,104 @@ proc_t* removeBlocked(int* semAddr)
         removeSemaphoreFromActiveList(semaphoreDescriptor);
     }
 
-    // Remove this semaphore from the process's semvac vector
-    removeSemaphoreFromProcessVector(semAddr, process);
     return process;
 }
 
 
 /*
-    Remove the process table entry pointed to by p from the queues associated with the
-    appropriate semaphores on the ASL. If the desired entry does not appear in any of
-    the process queues (an error condition), return ENULL. Otherwise, return p.
+    Search the ASL for a descriptor of this semaphore. If none is found, return 0. Otherwise,
+    empty its process queue and put the descriptor back on the free list. The process table
+    entries that are on no other queue are moved, in order, to the tail of the queue whose tail
+    is pointed to by tp; the others are only taken off the semaphore's queue. Return the number
+    of units the entries were waiting for (one per entry blocked by a plain P).
 */
-proc_t* outBlocked(proc_t* p)
+int removeBlockedAll(int* semAddr, proc_link* tp)
 {
-    // Iterate through Active Semaphores List (ASL) process queues
-    semd_t* semaphoreDescriptor = semd_h;
-    int processRemovedAtLeastOnce = FALSE;
+    semd_t* semaphoreDescriptor = getSemaphoreFromActiveList(semAddr);
 
-    while (semaphoreDescriptor != (semd_t*)ENULL) {
-        // Attempt to remove the given process from this ASL entry's proc queue
-        proc_link* tp = &semaphoreDescriptor->s_link;
-        int* semAddr = semaphoreDescriptor->s_semAdd;
-        semd_t* nextSemaphoreDescriptor = semaphoreDescriptor->s_next; 
+    // No entry is associated with the given address in the ASL
+    if (semaphoreDescriptor == (semd_t*)ENULL) {
+        return 0;
+    }
 
-        int wasRemoved = outProc(tp, p) != (proc_t*)ENULL ? 1 : 0;
+    // Detach the whole queue in one pass, then retire the descriptor. Processes in a wait-any also
+    // have to leave their other semaphores, so such a queue is released one process at a time
+    int units = semaphoreDescriptor->s_units;
+    if (semaphoreDescriptor->s_any == 0) {
+        semLinkCount -= semaphoreDescriptor->s_count;
+        spliceProc(&semaphoreDescriptor->s_link, tp);
+    }
+    else {
+        while (semaphoreDescriptor->s_link.next != (proc_t*)ENULL) {
+            releaseHead(semaphoreDescriptor, tp);
+        }
+    }
+    removeSemaphoreFromActiveList(semaphoreDescriptor);
+    return units;
+}
 
-        // Remove this semaphore from the process's semvac vector
-        if (wasRemoved) {
-            // We found and removed p from this semaphores's queue
-            *semAddr = *semAddr + 1;
-            processRemovedAtLeastOnce = TRUE;
 
-            // Remove semAddr from the process's semvec[]
-            removeSemaphoreFromProcessVector(semAddr, p);
+/*
+    Release the processes at the head of the queue of semaphore semAddr for as long as the units
+    the head waits for are available. The units available are the value of the semaphore plus the
+    units the blocked processes already took off it. Released entries that are on no other queue
+    are put at the tail of the queue whose tail is pointed to by tp. Return the number released.
+*/
+int releaseBlocked(int* semAddr, proc_link* tp)
+{
+    semd_t* semaphoreDescriptor = getSemaphoreFromActiveList(semAddr);
 
-            // If this Active Semaphore's process queue becomes empty, remove it from the ASL and put the semd back on the free list
-            if (tp->next == (proc_t*)ENULL) {
-                removeSemaphoreFromActiveList(semaphoreDescriptor);
-            }
-        }
+    // No entry is associated with the given address in the ASL
+    if (semaphoreDescriptor == (semd_t*)ENULL) {
+        return 0;
+    }
 
-        semaphoreDescriptor = nextSemaphoreDescriptor;
+    int released = releaseSatisfiedWaiters(semaphoreDescriptor, tp);
+    if (semaphoreDescriptor->s_link.next == (proc_t*)ENULL) {
+        removeSemaphoreFromActiveList(semaphoreDescriptor);
     }
+    return released;
+}
+
+
+/*
+    Remove the process table entry pointed to by p from the queues associated with the
+    appropriate semaphores on the ASL. If the desired entry does not appear in any of
+    the process queues (an error condition), return ENULL. Otherwise, return p.
+*/
+proc_t* outBlocked(proc_t* p)
+{
+    return outBlockedRelease(p, (proc_link*)ENULL);
+}
+
+
+/*
+    Same as outBlocked. The units p was waiting for go back to each semaphore, and unless tp is
+    ENULL the processes behind p that those units now satisfy are released as by releaseBlocked.
+*/
+proc_t* outBlockedRelease(proc_t* p, proc_link* tp)
+{
+    // The process's link nodes name every queue it is on, so only those are visited
+    // instead of trying every descriptor on the ASL
+    semd_t* detached[SEMMAX];
+    int n = detachProcess(p, FALSE, detached);
+    settleSemaphores(detached, n, tp);
 
     // If the process did not appear in any process queue, return ENULL
-    return processRemovedAtLeastOnce == TRUE ? p : (proc_t*)ENULL;
+    return n > 0 ? p : (proc_t*)ENULL;
+}
+
+
+/*
+    Same as outBlockedRelease, but p only leaves the semaphores it waits on as part of a wait-any
+    (used when one P of the wait-any gets its units straight away). Return ENULL if there were none.
+*/
+proc_t* outBlockedAny(proc_t* p, proc_link* tp)
+{
+    semd_t* detached[SEMMAX];
+    int n = detachProcess(p, TRUE, detached);
+    settleSemaphores(detached, n, tp);
+    return n > 0 ? p : (proc_t*)ENULL;
 }
 
 
@@ -155,6 +299,19 @@ proc_t* headBlocked(int* semAddr)
 }
 
 
+/*
+    Return the number of processes blocked on the semaphore semAdd (0 if it is not active).
+*/
+int countBlocked(int* semAddr)
+{
+    semd_t* semaphoreDescriptor = getSemaphoreFromActiveList(semAddr);
+    if (semaphoreDescriptor == (semd_t*)ENULL) {
+        return 0;
+    }
+    return semaphoreDescriptor->s_count;
+}
+
+
 /*
     Initialize the semaphore descriptor free list.
 
@@ -163,20 +320,91 @@ void initSemd()
 {
     // Use the first element of semdTable as free list head
     semdFree_h = &semdTable[0];
-    semdTable[0].s_prev = (semd_t*)ENULL;
-    semdTable[0].s_next = &semdTable[1];
+    semdCount = MAXSEMD;
 
     int i;
-    for (i = 1; i < MAXPROC - 1; i++) {
-        semdTable[i].s_next = &semdTable[i + 1];
-        semdTable[i].s_prev = &semdTable[i - 1];
+    for (i = 0; i < MAXSEMD; i++) {
+        semdTable[i].s_next = (i == MAXSEMD - 1) ? (semd_t*)ENULL : &semdTable[i + 1];
+        semdTable[i].s_prev = (semd_t*)ENULL;
     }
 
-    semdTable[MAXPROC - 1].s_next = (semd_t*)ENULL;
-    semdTable[MAXPROC - 1].s_prev = &semdTable[MAXPROC - 2];
-
     // Null terminate the free list
     semd_h = (semd_t*)ENULL;
+    semdSorted = TRUE;
+
+    // No semaphore is active, so every bucket of the hash index is empty
+    for (i = 0; i < SEMDHASH; i++) {
+        semdHash[i] = (semd_t*)ENULL;
+    }
+
+    // Every semaphore starts out FIFO
+    prioritySemaphoreCount = 0;
+}
+
+
+/*
+    Add the n semaphore descriptors starting at entries (memory set aside outside of semdTable,
+    e.g. carved at boot) to the free list. The hash index is sized for at most MAXSEMD + EXTRASEMD
+    descriptors, so any beyond that are left unused. Return the number of descriptors added.
+*/
+int extendSemd(semd_t* entries, int n)
+{
+    if (n > SEMDTOTAL - semdCount) {
+        n = SEMDTOTAL - semdCount;
+    }
+
+    int i;
+    for (i = 0; i < n; i++) {
+        returnSemaphoreToFreeList(&entries[i]);
+    }
+
+    semdCount += n;
+    return n;
+}
+
+
+/*
+    Set the order in which processes wait on the semaphore semAdd: SEMFIFO (the default) or
+    SEMPRIORITY. The policy outlives the semaphore's descriptor, so it is kept in a table of
+    SEMPOLICIES entries; return TRUE if that table is full, FALSE otherwise. Processes already
+    waiting keep their places, only those that block from now on are placed by the new policy.
+*/
+int setSemaphorePolicy(int* semAddr, int policy)
+{
+    int i = findPrioritySemaphore(semAddr);
+
+    if (policy == SEMPRIORITY && i == ENULL) {
+        if (prioritySemaphoreCount == SEMPOLICIES) {
+            return TRUE;
+        }
+        prioritySemaphores[prioritySemaphoreCount++] = semAddr;
+    }
+    else if (policy == SEMFIFO && i != ENULL) {
+        // Fill the hole with the last entry, the table is not ordered
+        prioritySemaphores[i] = prioritySemaphores[--prioritySemaphoreCount];
+    }
+
+    semd_t* semaphoreDescriptor = getSemaphoreFromActiveList(semAddr);
+    if (semaphoreDescriptor != (semd_t*)ENULL) {
+        semaphoreDescriptor->s_policy = policy;
+    }
+    return FALSE;
+}
+
+
+/*
+    Move p, blocked on the semaphore semAdd, to the place its p_priority now gives it on that
+    semaphore's queue (used when p inherits a priority). p keeps its link node and its units.
+    Return TRUE if p is not blocked on that semaphore, FALSE otherwise.
+*/
+int requeueBlocked(int* semAddr, proc_t* p)
+{
+    semd_t* semaphoreDescriptor = getSemaphoreFromActiveList(semAddr);
+
+    if (semaphoreDescriptor == (semd_t*)ENULL) {
+        return TRUE;
+    }
+    return requeueProcPriority(&semaphoreDescriptor->s_link, p);
 }
 
 
@@ -190,6 +418,19 @@ int headASL()
 }
 
 
+/*
+    Return the head of the ASL with the descriptors in semaphore address order, for walks that need
+    that order. The ASL is sorted here, only if a descriptor became active out of order since the last call.
+*/
+semd_t* orderedASL()
+{
+    if (!semdSorted) {
+        sortActiveList();
+    }
+    return semd_h;
+}
+
+
 /*
     Acquire a semaphore descriptor from the free list and initialize an associated 
     process queue for managing blocked processes.
@@ -211,46 +452,90 @@ semd_t* allocateSemaphoreFromFreeList()
 
 
 /*
-    Insert a new Semaphore Descriptor into the ASL, which is ordered by semaphore addresses.
-    Uses insertion sort starting from the head.
+    Insert a new Semaphore Descriptor at the head of the ASL. Lookups go through the hash index,
+    so the ASL is only put back in address order when orderedASL asks for it, and a semaphore
+    that becomes active does not pay for a walk.
 */
 void insertSemaphoreIntoActiveList(semd_t* s)
 {
-    // Insertion into empty ASL
-    if (semd_h == (semd_t*)ENULL) {
-        semd_h = s;
-        s->s_next = (semd_t*)ENULL;
-        s->s_prev = (semd_t*)ENULL;
-        return;
-    }
+    // Index the descriptor by its address so lookups do not have to walk the ASL
+    insertSemaphoreIntoHashIndex(s);
 
-    semd_t* currSemd = semd_h;
-    semd_t* insertSemd = s;
+    s->s_prev = (semd_t*)ENULL;
+    s->s_next = semd_h;
+    if (semd_h != (semd_t*)ENULL) {
+        semd_h->s_prev = s;
 
-    // Insertion required at head (direct pointer comparison)
-    if (insertSemd->s_semAdd < currSemd->s_semAdd) {
-        insertSemd->s_next = currSemd;
-        insertSemd->s_prev = (semd_t*)ENULL;
-        currSemd->s_prev = insertSemd;
-        semd_h = insertSemd;
-        return;
+        // The list is still in address order only if the new head comes before the old one
+        if (s->s_semAdd > semd_h->s_semAdd) {
+            semdSorted = FALSE;
+        }
     }
+    semd_h = s;
+}
 
-    // Otherwise insertion will happen in the middle or at end of the ASL
-    semd_t* prevSemd = currSemd;
-    while (currSemd != (semd_t*)ENULL && insertSemd->s_semAdd > currSemd->s_semAdd) {
-        prevSemd = currSemd;
-        currSemd = currSemd->s_next;
-    }
 
-    // Insert this entry before curr and after prev semd_t
-    prevSemd->s_next = insertSemd;
-    insertSemd->s_prev = prevSemd;
-    insertSemd->s_next = currSemd;
+/*
+    Put the ASL back in address order with a bottom-up merge sort of semd_h (O(n log n), no recursion),
+    then mend the back links.
+*/
+void sortActiveList()
+{
+    semd_t* list = semd_h;
+    int width;
+
+    for (width = 1; list != (semd_t*)ENULL; width *= 2) {
+        semd_t* left = list;
+        semd_t* tail = (semd_t*)ENULL;
+        int merges = 0;
+        list = (semd_t*)ENULL;
+
+        // Merge the runs of width descriptors pairwise
+        while (left != (semd_t*)ENULL) {
+            semd_t* right = left;
+            int leftSize = 0;
+            int rightSize = width;
+            merges++;
+
+            while (leftSize < width && right != (semd_t*)ENULL) {
+                leftSize++;
+                right = right->s_next;
+            }
 
-    if (currSemd != (semd_t*)ENULL) {
-        currSemd->s_prev = insertSemd;
+            while (leftSize > 0 || (rightSize > 0 && right != (semd_t*)ENULL)) {
+                semd_t* next;
+                if (leftSize == 0 || (rightSize > 0 && right != (semd_t*)ENULL && right->s_semAdd < left->s_semAdd)) {
+                    next = right;
+                    right = right->s_next;
+                    rightSize--;
+                }
+                else {
+                    next = left;
+                    left = left->s_next;
+                    leftSize--;
+                }
+
+                if (tail == (semd_t*)ENULL) {
+                    list = next;
+                }
+                else {
+                    tail->s_next = next;
+                }
+                next->s_prev = tail;
+                tail = next;
+            }
+            left = right;
+        }
+        tail->s_next = (semd_t*)ENULL;
+
+        // One merge means the whole list was a single run
+        if (merges <= 1) {
+            break;
+        }
     }
+
+    semd_h = list;
+    semdSorted = TRUE;
 }
 
 
@@ -259,11 +544,14 @@ void insertSemaphoreIntoActiveList(semd_t* s)
 */
 void removeSemaphoreFromActiveList(semd_t* s)
 {
-    // Edge case
-    if (semd_h == (semd_t*)ENULL || s == (semd_t*)ENULL) {
+    // Edge case (a descriptor retired while a wait-any was being released may be named twice)
+    if (semd_h == (semd_t*)ENULL || s == (semd_t*)ENULL || s->s_semAdd == (int*)ENULL) {
         return;
     }
 
+    // Drop the descriptor from the hash index while s_semAdd still holds its key
+    removeSemaphoreFromHashIndex(s);
+
     // Removal of head
     if (s == semd_h) {
         semd_h = s->s_next;
@@ -291,13 +579,15 @@ void removeSemaphoreFromActiveList(semd_t* s)
 */
 semd_t* getSemaphoreFromActiveList(int* semAddr) 
 {
-    semd_t* semDescriptor = semd_h;
+    // Probe the hash index from the home bucket until we hit the key or an empty bucket
+    int bucket = hashSemaphoreAddress(semAddr);
 
-    while (semDescriptor != (semd_t*)ENULL) {
-        if (semDescriptor->s_semAdd == semAddr) {
-            return semDescriptor;
+    while (semdHash[bucket] != (semd_t*)ENULL) {
+        COUNT_PROBE();
+        if (semdHash[bucket]->s_semAdd == semAddr) {
+            return semdHash[bucket];
         }
-        semDescriptor = semDescriptor->s_next;
+        bucket = (bucket + 1) & (SEMDHASH - 1);
     }
 
     return (semd_t*)ENULL;
@@ -305,42 +595,224 @@ semd_t* getSemaphoreFromActiveList(int* semAddr)
 
 
 /*
-    Add the semaphore specified by semAddr to the vector of active semaphores 
-    associated with the given process.
+    Return the home bucket of the given semaphore address in the hash index. Semaphores are
+    word aligned, so the low bits are dropped and some higher bits are folded in to spread
+    addresses that are far apart. Only shifts and masks are used, no multiply or divide.
 */
-void addSemaphoreToProcessVector(int* semAddr, proc_t* p)
+int hashSemaphoreAddress(int* semAddr)
 {
-    if (p == (proc_t*)ENULL || semAddr == (int*)ENULL) {
-        return;
+    unsigned long addr = (unsigned long)semAddr;
+    return (int)(((addr >> 2) ^ (addr >> 11)) & (SEMDHASH - 1));
+}
+
+
+/*
+    Add the given active semaphore descriptor to the hash index using linear probing.
+    There are at most MAXSEMD + EXTRASEMD active descriptors, so a free bucket always exists.
+*/
+void insertSemaphoreIntoHashIndex(semd_t* s)
+{
+    int bucket = hashSemaphoreAddress(s->s_semAdd);
+
+    while (semdHash[bucket] != (semd_t*)ENULL) {
+        bucket = (bucket + 1) & (SEMDHASH - 1);
     }
 
-    int i;
-    for (i = 0; i < SEMMAX; i++) {
-        if (p->semvec[i] == (int*)ENULL) {
-            p->semvec[i] = semAddr;
+    semdHash[bucket] = s;
+}
+
+
+/*
+    Remove the given semaphore descriptor from the hash index. Rather than leaving a tombstone,
+    entries further along the probe run are shifted back into the hole when their home bucket
+    allows it, so lookups can always stop at the first empty bucket.
+*/
+void removeSemaphoreFromHashIndex(semd_t* s)
+{
+    // Find the bucket that holds this descriptor
+    int hole = hashSemaphoreAddress(s->s_semAdd);
+    while (semdHash[hole] != s) {
+        if (semdHash[hole] == (semd_t*)ENULL) {
             return;
         }
+        hole = (hole + 1) & (SEMDHASH - 1);
+    }
+    semdHash[hole] = (semd_t*)ENULL;
+
+    // Walk the rest of the probe run and move back entries that would otherwise become unreachable
+    int bucket = (hole + 1) & (SEMDHASH - 1);
+    while (semdHash[bucket] != (semd_t*)ENULL) {
+        int home = hashSemaphoreAddress(semdHash[bucket]->s_semAdd);
+
+        // The entry may move into the hole only if the hole lies cyclically between its home and its bucket
+        int distanceToHole = (hole - home) & (SEMDHASH - 1);
+        int distanceToBucket = (bucket - home) & (SEMDHASH - 1);
+        if (distanceToHole < distanceToBucket) {
+            semdHash[hole] = semdHash[bucket];
+            semdHash[bucket] = (semd_t*)ENULL;
+            hole = bucket;
+        }
+
+        bucket = (bucket + 1) & (SEMDHASH - 1);
     }
 }
 
 
 /*
-    Remove the semaphore specified by semAddr from the vector of active semaphores 
-    associated with the given process.
+    Record the units the given process waits for on s in the link node that holds the process on
+    its queue. The process must have just been inserted in that queue, so the node is the newest
+    of its own nodes (not necessarily the tail's, with SEMPRIORITY).
 */
-void removeSemaphoreFromProcessVector(int* semAddr, proc_t* p)
+void recordSemaphoreInProcessLink(semd_t* s, proc_t* p, int units, int any)
 {
-    if (p == (proc_t*)ENULL || semAddr == (int*)ENULL) {
-        return;
+    linkPool[p->p_link].units = units;
+    linkPool[p->p_link].any = any;
+    s->s_units += units;
+    s->s_count++;
+    semLinkCount++;
+    if (any != ENULL) {
+        s->s_any++;
+    }
+}
+
+
+/*
+    Return the descriptor of the semaphore on whose queue the link node at idx holds its owner, or
+    ENULL if the node is on some other queue (only semaphore waiters wait for units). The tail pointer
+    of a semaphore queue is the s_link of its descriptor, so no lookup is needed.
+*/
+semd_t* semaphoreOfLink(int idx)
+{
+    if (linkPool[idx].units == 0) {
+        return (semd_t*)ENULL;
     }
+    return (semd_t*)((char*)linkPool[idx].tp - ((char*)&semdTable[0].s_link - (char*)&semdTable[0]));
+}
+
+
+/*
+    Take processes off the head of the queue of s while the units the head waits for are
+    available, putting those on no other queue at the tail of the queue pointed to by tp.
+    The descriptor is left on the ASL even if its queue empties. Return the number released.
+*/
+int releaseSatisfiedWaiters(semd_t* s, proc_link* tp)
+{
+    int released = 0;
+    while (s->s_link.next != (proc_t*)ENULL) {
+        int units = linkPool[linkPool[s->s_link.index].next].units;
+        if (units > *s->s_semAdd + s->s_units) {
+            break;
+        }
 
+        // The head's units were already taken off the semaphore when it blocked
+        releaseHead(s, tp);
+        released++;
+    }
+    return released;
+}
+
+
+/*
+    Take the process at the head of the queue of s off it, and put it at the tail of the queue
+    pointed to by tp if it is on no other queue (tp may be ENULL to leave that to the caller).
+    A process in a wait-any has now fired: the index of its P goes in D3 of its saved state and
+    it leaves the other semaphores of the wait, as by outBlockedAny. Return the process.
+*/
+proc_t* releaseHead(semd_t* s, proc_link* tp)
+{
+    int node = linkPool[s->s_link.index].next;
+    int any = linkPool[node].any;
+
+    s->s_units -= linkPool[node].units;
+    s->s_count--;
+    semLinkCount--;
+    proc_t* process = removeProc(&s->s_link);
+
+    semd_t* detached[SEMMAX];
+    int n = 0;
+    if (any != ENULL) {
+        s->s_any--;
+        process->p_cold->p_s.s_r[3] = any;
+        n = detachProcess(process, TRUE, detached);
+    }
+
+    if (tp != (proc_link*)ENULL && process->qcount == 0) {
+        insertProc(tp, process);
+    }
+
+    // Releasing waiters behind p may fire other wait-anys, so this only happens once p is fully off
+    settleSemaphores(detached, n, tp);
+    return process;
+}
+
+
+/*
+    Take p off the queues of the semaphores it is blocked on (only those of its wait-any if anyOnly)
+    and give the units it was waiting for back to each semaphore. The descriptors are stored in
+    detached for settleSemaphores; nothing else is released here, so p's link nodes can be walked
+    safely. Return the number of descriptors stored.
+*/
+int detachProcess(proc_t* p, int anyOnly, semd_t* detached[])
+{
+    int n = 0;
+    int i = p->p_link;
+    while (i != ENULL) {
+        semd_t* semaphoreDescriptor = semaphoreOfLink(i);
+        int units = linkPool[i].units;
+        int any = linkPool[i].any;
+        int node = i;
+        i = linkPool[i].sibling;
+
+        // Skip nodes that hold the process on a queue other than a semaphore's (e.g. the RQ)
+        if (semaphoreDescriptor == (semd_t*)ENULL || (anyOnly && any == ENULL)) {
+            continue;
+        }
+
+        // Unlink p from this semaphore's queue, which also releases the node, and give back the units it took
+        unlinkProc(&semaphoreDescriptor->s_link, p, node);
+        *semaphoreDescriptor->s_semAdd += units;
+        semaphoreDescriptor->s_units -= units;
+        semaphoreDescriptor->s_count--;
+        semLinkCount--;
+        if (any != ENULL) {
+            semaphoreDescriptor->s_any--;
+        }
+        detached[n++] = semaphoreDescriptor;
+    }
+    return n;
+}
+
+
+/*
+    After processes were detached from the given semaphores, release (unless tp is ENULL) the
+    waiters that the units given back now satisfy, and retire the descriptors whose queue is empty.
+*/
+void settleSemaphores(semd_t* detached[], int n, proc_link* tp)
+{
     int i;
-    for (i = 0; i < SEMMAX; i++) {
-        if (p->semvec[i] == semAddr) {
-            p->semvec[i] = (int*)ENULL;
-            return;
+    for (i = 0; i < n; i++) {
+        if (tp != (proc_link*)ENULL) {
+            releaseSatisfiedWaiters(detached[i], tp);
+        }
+        if (detached[i]->s_link.next == (proc_t*)ENULL) {
+            removeSemaphoreFromActiveList(detached[i]);
+        }
+    }
+}
+
+
+/*
+    Return the position of semAddr in the table of semaphores with the SEMPRIORITY policy, or ENULL.
+*/
+int findPrioritySemaphore(int* semAddr)
+{
+    int i;
+    for (i = 0; i < prioritySemaphoreCount; i++) {
+        if (prioritySemaphores[i] == semAddr) {
+            return i;
         }
     }
+    return ENULL;
 }
 
 
@@ -371,4 +843,8 @@ void resetSemaphore(semd_t* s)
     s->s_semAdd = (int*)ENULL;
     s->s_link.index = ENULL;
     s->s_link.next = (proc_t*)ENULL;
+    s->s_units = 0;
+    s->s_count = 0;
+    s->s_any = 0;
+    s->s_policy = SEMFIFO;
 }
@@ -0,0 +1,133 @@
+/*********************************ASLBENCH.C*******************************
+ *
+ *	Op-count benchmark for the ASL lookup (host build, "make aslbench").
+ *
+ *	Blocks processes on up to SEMMAX semaphores each, so that hundreds of
+ *	semaphores are active, and then replays the lookups the nucleus does:
+ *	headBlocked on active and on idle semaphores (intdeadlock) and a V
+ *	followed by a P on every active semaphore (removeBlocked/insertBlocked).
+ *
+ *	For every lookup it counts the descriptors that the address-sorted walk
+ *	of semd_h examined before the hash index existed, next to the
+ *	descriptors the hash index examines now.
+ */
+#include <stdio.h>
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../h/procq.e"
+#include "../h/asl.e"
+
+#define	MAXSEM	(MAXPROC < 20 * SEMMAX ? MAXPROC : 20 * SEMMAX)
+
+extern long semdProbes;
+
+int sem[MAXSEM];	/* semaphores that get a blocked process */
+int idlesem[MAXSEM];	/* semaphores that are never active */
+proc_t *procp[MAXSEM];	/* process blocked on sem[i] */
+
+long walked;		/* descriptors the sorted-list walk would examine */
+long lookups;		/* number of ASL lookups replayed */
+
+
+/* Cost of the old getSemaphoreFromActiveList(): walk semd_h until found or the end */
+long walkcost(int *semAddr)
+{
+	long n = 0;
+	semd_t *s;
+
+	for (s = orderedASL(); s != (semd_t *) ENULL; s = s->s_next) {
+		n++;
+		if (s->s_semAdd == semAddr)
+			break;
+	}
+	return (n);
+}
+
+
+/* Block up to SEMMAX semaphores on each process, in a scrambled order */
+void block(int nsem)
+{
+	int i, k;
+	proc_t *p = (proc_t *) ENULL;
+
+	for (i = 0; i < nsem; i++) {
+		k = (i * 7919) % nsem;
+		if (i % SEMMAX == 0 && (p = allocProc()) == (proc_t *) ENULL) {
+			printf("aslbench: out of processes\n");
+			return;
+		}
+		procp[k] = p;
+		if (insertBlocked(&sem[k], p)) {
+			printf("aslbench: out of semaphore descriptors\n");
+			return;
+		}
+	}
+}
+
+
+void run(int nsem)
+{
+	int i, round;
+	long hitWalk = 0, hitHash = 0, missWalk = 0, missHash = 0;
+	long churnWalk = 0, churnHash = 0, before;
+	proc_t *p;
+
+	initProc();
+	initSemd();
+	block(nsem);
+
+	for (round = 0; round < 10; round++) {
+		/* headBlocked on active semaphores */
+		for (i = 0; i < nsem; i++) {
+			hitWalk += walkcost(&sem[i]);
+			before = semdProbes;
+			headBlocked(&sem[i]);
+			hitHash += semdProbes - before;
+		}
+
+		/* headBlocked on semaphores nobody waits on */
+		for (i = 0; i < nsem; i++) {
+			missWalk += walkcost(&idlesem[i]);
+			before = semdProbes;
+			headBlocked(&idlesem[i]);
+			missHash += semdProbes - before;
+		}
+
+		/* V then P on every active semaphore */
+		for (i = 0; i < nsem; i++) {
+			churnWalk += walkcost(&sem[i]);
+			before = semdProbes;
+			p = removeBlocked(&sem[i]);
+			churnHash += semdProbes - before;
+
+			churnWalk += walkcost(&sem[i]);
+			before = semdProbes;
+			insertBlocked(&sem[i], p);
+			churnHash += semdProbes - before;
+		}
+	}
+
+	lookups = 10L * nsem;
+	printf("%6d  %-22s %10.2f %10.2f\n", nsem, "headBlocked (active)",
+	    (double) hitWalk / lookups, (double) hitHash / lookups);
+	printf("%6s  %-22s %10.2f %10.2f\n", "", "headBlocked (idle)",
+	    (double) missWalk / lookups, (double) missHash / lookups);
+	printf("%6s  %-22s %10.2f %10.2f\n", "", "removeBlocked+insert",
+	    (double) churnWalk / lookups, (double) churnHash / lookups);
+}
+
+
+int main()
+{
+	int n;
+
+	printf("descriptors examined per operation\n");
+	printf("%6s  %-22s %10s %10s\n", "active", "operation", "sorted", "hash");
+	for (n = 25; n <= MAXSEM; n *= 2)
+		run(n);
+	if (n / 2 != MAXSEM)
+		run(MAXSEM);
+	return (0);
+}
@@ -0,0 +1,23 @@
+/*
+    Host stand-ins for the routines that trap into the simulator, so that the queue
+    modules can be compiled and run natively by the host targets in the Makefile.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+
+extern char msgbuf[];
+
+
+/*
+    Same contract as panic() in procq.c: keep the message in msgbuf and stop. On the
+    host there is no simulator to halt, so report the message and exit instead.
+*/
+void panic(char* message)
+{
+    char* i = msgbuf;
+    while ((*i++ = *message++) != '\0')
+        ;
+
+    fprintf(stderr, "panic: %s\n", msgbuf);
+    exit(1);
+}
@@ -6,61 +6,160 @@
 #include "../h/types.h"
 #include "../h/procq.e"
 
-#define FREE_LIST 0
 proc_t procTable[MAXPROC];		            /* Universal table of all processes */
+#ifndef COLDINLINE
+proc_cold procColdTable[MAXPROC];           /* Cold part of each procTable entry, kept apart so the queues stay dense */
+#endif
 proc_t* procFree_h = (proc_t*)ENULL;		/* List which contains all unused proc_t in the procTable */
+int procFreeCount = 0;                      /* Number of entries on the procFree list */
+
+#if MAXLINKS <= MAXPROC + EXTRAPROC
+#error "MAXLINKS must leave room for every process on a process queue and for some semaphore waiters"
+#endif
+
+link_t linkPool[MAXLINKS];                  /* Queue link nodes, handed to a process only while it is on a queue */
+int linkFree_h = ENULL;                     /* linkPool index of the first unused link node */
 
 char msgbuf[128];	            /* nonrecoverable error message before shut down */
 
 /* Local Utility Routines */
 void panic(char* message);
-int findAvailableQueueSlot(proc_t* p);
+int allocLink(proc_t* p);
+void freeLink(proc_t* p, int idx);
+int findQueueSlot(proc_link* tp, proc_t* p);
+int findPrioritySlot(proc_link* tp, proc_t* p);
 void resetProcess(proc_t* p);
 
 
 /*
     Insert the element pointed to by p into the process queue where tp contains the
-    pointer/index to the tail (last element). Update the tail pointer accordingly. 
+    pointer/index to the tail (last element). Update the tail pointer accordingly.
     If the process is already in the SEMMAX queues, call the panic function.
+    Return TRUE if no link node was free (p is not inserted), FALSE otherwise.
 */
-void insertProc(proc_link* tp, proc_t* p)
+int insertProc(proc_link* tp, proc_t* p)
 {
     // Ensure the process is in less than SEMMAX queues
     if (p->qcount >= SEMMAX) {
         panic("proc_t* p is on the maximum number of queues.");
     }
     else {
+        // Take a link node from the pool for this process and tag it with the queue it now belongs to
+        int proc_queue_idx = allocLink(p);
+        if (proc_queue_idx == ENULL) {
+            return TRUE;
+        }
+        link_t* link = &linkPool[proc_queue_idx];
+        link->tp = tp;
+
         // Handle insertion when process queue is empty
         if (tp->next == (proc_t*)ENULL) {
-            tp->next = p;
-            tp->index = findAvailableQueueSlot(p);
-            p->p_link[tp->index].index = tp->index;		// the process is the tail & head
-            p->p_link[tp->index].next = p;
-            p->qcount++;
+            link->next = proc_queue_idx;		// the process is the tail & head
+            link->prev = proc_queue_idx;
         }
         else {
-            // Find a free proc link index for this process
-            int proc_queue_idx = findAvailableQueueSlot(p);
             int tail_queue_idx = tp->index;
+            int head_queue_idx = linkPool[tail_queue_idx].next;
+
+            // New Tail points forward to Head and back to the old Tail
+            link->next = head_queue_idx;
+            link->prev = tail_queue_idx;
 
-            // Initialize the new process's link
-            proc_t* headProc = tp->next->p_link[tail_queue_idx].next;
-            int head_queue_idx = tp->next->p_link[tail_queue_idx].index;
+            // Old Tail points to new Tail and Head points back to new Tail
+            linkPool[tail_queue_idx].next = proc_queue_idx;
+            linkPool[head_queue_idx].prev = proc_queue_idx;
+        }
 
-            // Tail points to new Tail
-            tp->next->p_link[tail_queue_idx].next = p;			    	// old tail points to new tail (p)
-            tp->next->p_link[tail_queue_idx].index = proc_queue_idx;	// the old tail's next index is the idx we found for this new proc
+        // Update tail pointer and the new process's fields
+        p->qcount++;
+        tp->next = p;                   // new tail
+        tp->index = proc_queue_idx;     // the link node through which the tail is on this queue
+        return FALSE;
+    }
+    return TRUE;
+}
 
-            // New Tail points to Head
-            p->p_link[proc_queue_idx].next = headProc;				    // new tail (p) points to the head
-            p->p_link[proc_queue_idx].index = head_queue_idx;		    // the index of the queue where the next proc_t is located 
 
-            // Update tail pointer and the new process's fields
-            p->qcount++;
-            tp->next = p;                   // new tail
-            tp->index = proc_queue_idx;     // update the index for which the queue tail belongs to
+/*
+    Insert p into the process queue whose tail is pointed to by tp behind every entry whose p_priority
+    is the same or higher, so a queue filled this way stays ordered by priority and FIFO among equals.
+    The queue is searched back from the tail, so this costs no more than insertProc when p is no
+    more urgent than the tail. Return TRUE if no link node was free, as insertProc.
+*/
+int insertProcPriority(proc_link* tp, proc_t* p)
+{
+    // An empty queue, or a tail at least as urgent as p, takes p at the tail
+    if (tp->next == (proc_t*)ENULL || tp->next->p_priority >= p->p_priority) {
+        return insertProc(tp, p);
+    }
+
+    // Ensure the process is in less than SEMMAX queues
+    if (p->qcount >= SEMMAX) {
+        panic("proc_t* p is on the maximum number of queues.");
+    }
+    else {
+        // Find the node p goes in after
+        int after_queue_idx = findPrioritySlot(tp, p);
+
+        // Take a link node from the pool and splice it in after that node. The tail stays where it is
+        int proc_queue_idx = allocLink(p);
+        if (proc_queue_idx == ENULL) {
+            return TRUE;
         }
+        link_t* link = &linkPool[proc_queue_idx];
+        link->tp = tp;
+        link->prev = after_queue_idx;
+        link->next = linkPool[after_queue_idx].next;
+        linkPool[link->next].prev = proc_queue_idx;
+        linkPool[after_queue_idx].next = proc_queue_idx;
+
+        p->qcount++;
+        return FALSE;
     }
+    return TRUE;
+}
+
+
+/*
+    Move p, which is on the process queue whose tail is pointed to by tp, to the place its p_priority
+    now gives it there, as insertProcPriority would. p keeps its link node, so this cannot run out of
+    them. Return TRUE if p is not on that queue, FALSE otherwise.
+*/
+int requeueProcPriority(proc_link* tp, proc_t* p)
+{
+    int proc_queue_idx = findQueueSlot(tp, p);
+    if (proc_queue_idx == ENULL) {
+        return TRUE;
+    }
+
+    // Alone on the queue, p is already in place
+    link_t* link = &linkPool[proc_queue_idx];
+    if (link->next == proc_queue_idx) {
+        return FALSE;
+    }
+
+    // Take the node out of the ring without giving it back to the pool
+    linkPool[link->prev].next = link->next;
+    linkPool[link->next].prev = link->prev;
+    if (tp->index == proc_queue_idx) {
+        tp->next = linkPool[link->prev].owner;
+        tp->index = link->prev;
+    }
+
+    // A tail at least as urgent as p takes p behind it as the new tail, otherwise p goes in where the search puts it
+    int after_queue_idx = tp->index;
+    if (linkPool[after_queue_idx].owner->p_priority >= p->p_priority) {
+        tp->next = p;
+        tp->index = proc_queue_idx;
+    }
+    else {
+        after_queue_idx = findPrioritySlot(tp, p);
+    }
+    link->prev = after_queue_idx;
+    link->next = linkPool[after_queue_idx].next;
+    linkPool[link->next].prev = proc_queue_idx;
+    linkPool[after_queue_idx].next = proc_queue_idx;
+    return FALSE;
 }
 
 
@@ -76,33 +175,11 @@ proc_t* removeProc(proc_link* tp)
         return (proc_t*)ENULL;
     }
 
-    // Fetch the head (tp->next->link[idx].next) and the tail (tp->next)
-    proc_t* headProc = headQueue(*tp);
-    proc_t* tailProc = tp->next;
-    int tail_queue_idx = tp->index;
+    // The head is found through the tail's link node (linkPool[tp->index])
+    int head_queue_idx = linkPool[tp->index].next;
+    proc_t* headProc = linkPool[head_queue_idx].owner;
 
-    // For single element process queue
-    if (headProc == tailProc) {
-        tailProc->p_link[tail_queue_idx].next = (proc_t*)ENULL;
-        tailProc->p_link[tail_queue_idx].index = ENULL;
-        tailProc->qcount--;
-        tp->next = (proc_t*)ENULL;
-        tp->index = ENULL;
-        return tailProc;
-    }
-
-    // Grab the index of the heads next element's corresponding queue
-    int head_queue_idx = tailProc->p_link[tail_queue_idx].index;
-
-    // Update the tail next to be the heads next proc (using the index at tp->next)
-    // and the index to that of the index from the head link (this is the index for head->next)
-    tailProc->p_link[tail_queue_idx].index = headProc->p_link[head_queue_idx].index;
-    tailProc->p_link[tail_queue_idx].next = headProc->p_link[head_queue_idx].next;
-
-    // Remove the process's proc_link from this queue and update fields
-    headProc->p_link[tail_queue_idx].index = ENULL;
-    headProc->p_link[tail_queue_idx].next = (proc_t*)ENULL;
-    headProc->qcount--;
+    unlinkProc(tp, headProc, head_queue_idx);
     return headProc;
 }
 
@@ -119,53 +196,90 @@ proc_t* outProc(proc_link* tp, proc_t* p)
         return (proc_t*)ENULL;
     }
 
-    // Fetch the head (tp->next->link[tp->index].next) and the tail (tp->next)
-    proc_t* headProc = headQueue(*tp);
-    proc_t* tailProc = tp->next;
-
-    // For single element process queue where the head is our target process
-    if (p == headProc) {
-        return removeProc(tp);
+    // Find the link node of this process that belongs to the given queue
+    int proc_queue_idx = findQueueSlot(tp, p);
+    if (proc_queue_idx == ENULL) {
+        return (proc_t*)ENULL;
     }
 
-    // Search queue for given process
-    int prev_queue_idx = tp->index;								    // tail index
-    int curr_queue_idx = tailProc->p_link[tp->index].index;         // head index
-    proc_t* currProc = headProc;
-    proc_t* prevProc;
+    // The back link lets us splice p out without searching the queue for its predecessor
+    unlinkProc(tp, p, proc_queue_idx);
+    return p;
+}
 
-    while (currProc != p) {
-        // Keep track of prev process
-        prevProc = currProc;
-        // Update the prev process index
-        prev_queue_idx = curr_queue_idx;
-        // The next index will be from the curr process's next index
-        curr_queue_idx = currProc->p_link[curr_queue_idx].index;
-        // Recall that tail_queue_idx is the prev procs index
-        currProc = currProc->p_link[prev_queue_idx].next;
 
-        // Case where we traverse Q and p is not found
-        if (currProc == headQueue(*tp)) {
-            return (proc_t*)ENULL;
-        }
+/*
+    Empty the process queue whose tail is pointed to by from. Entries that are on no other
+    queue are moved, in order, to the tail of the queue whose tail is pointed to by to: their
+    link nodes are retagged and the run of them is spliced into that queue at once. Entries
+    that are still on other queues are only taken off from. Return the number of entries
+    that were on from.
+*/
+int spliceProc(proc_link* from, proc_link* to)
+{
+    if (from->next == (proc_t*)ENULL) {
+        return 0;
     }
 
-    // We reached the tail and it is the target p
-    if (currProc == tailProc && p == tailProc) {
-        tp->next = prevProc;  // proc before tail becomes new tail
-        tp->index = prev_queue_idx; 
-    }
+    // Walk the queue once from its head, building the run of nodes that move as a chain
+    int tail_queue_idx = from->index;
+    int idx = linkPool[tail_queue_idx].next;
+    int first = ENULL;
+    int last = ENULL;
+    int n = 0;
+    while (TRUE) {
+        int next_queue_idx = linkPool[idx].next;
+        proc_t* p = linkPool[idx].owner;
+        n++;
+
+        if (p->qcount == 1) {
+            // The node now holds p on the destination queue instead
+            linkPool[idx].tp = to;
+            linkPool[idx].units = 0;
+            linkPool[idx].any = ENULL;
+            if (last == ENULL) {
+                first = idx;
+            }
+            else {
+                linkPool[last].next = idx;
+                linkPool[idx].prev = last;
+            }
+            last = idx;
+        }
+        else {
+            // p stays on its other queues and only gives this node back
+            freeLink(p, idx);
+            p->qcount--;
+        }
 
-    // Remove the current process from this queue by pointing the prev process next and index to the next process
-    prevProc->p_link[prev_queue_idx].index = p->p_link[curr_queue_idx].index;
-    prevProc->p_link[prev_queue_idx].next = p->p_link[curr_queue_idx].next;
+        if (idx == tail_queue_idx) {
+            break;
+        }
+        idx = next_queue_idx;
+    }
+    from->next = (proc_t*)ENULL;
+    from->index = ENULL;
 
-    // Update the removed process's fields
-    p->p_link[curr_queue_idx].next = (proc_t*)ENULL;
-    p->p_link[curr_queue_idx].index = ENULL;
-    p->qcount--;
+    if (first == ENULL) {
+        return n;
+    }
 
-    return p;
+    // Close the run into a ring, or splice it in between the destination's tail and head
+    if (to->next == (proc_t*)ENULL) {
+        linkPool[last].next = first;
+        linkPool[first].prev = last;
+    }
+    else {
+        int to_tail_idx = to->index;
+        int to_head_idx = linkPool[to_tail_idx].next;
+        linkPool[to_tail_idx].next = first;
+        linkPool[first].prev = to_tail_idx;
+        linkPool[last].next = to_head_idx;
+        linkPool[to_head_idx].prev = last;
+    }
+    to->next = linkPool[last].owner;
+    to->index = last;
+    return n;
 }
 
 
@@ -173,44 +287,94 @@ proc_t* outProc(proc_link* tp, proc_t* p)
     Return ENULL if the procFree list is empty.
     Otherwise, remove an element from the procFree list and return a pointer to it.
 */
-proc_t* allocProc() 
+proc_t* allocProc()
 {
     // Free Process List is empty
     if (procFree_h == (proc_t*)ENULL) {
         return (proc_t*)ENULL;
     }
 
-    // First element of the procFree list
+    // First element of the procFree list, which is the most recently freed one
     proc_t* allocatedProc = procFree_h;
 
     // Remove the first element of the Free Process List and update pointers
-    procFree_h = allocatedProc->p_link[FREE_LIST].next;
-    allocatedProc->p_link[FREE_LIST].next = (proc_t*)ENULL;
-    allocatedProc->p_link[FREE_LIST].index= ENULL;
+    procFree_h = allocatedProc->p_next;
+    procFreeCount--;
+    allocatedProc->p_next = (proc_t*)ENULL;
     return allocatedProc;
 }
 
 
 /*
-    Reinsert the element pointed to by p into the procFree list.
+    Remove n elements from the procFree list and return them as a list linked through
+    p_next and terminated by ENULL. If fewer than n elements are free, nothing is removed
+    and ENULL is returned.
+*/
+proc_t* allocProcN(int n)
+{
+    if (n <= 0 || n > procFreeCount) {
+        return (proc_t*)ENULL;
+    }
+
+    // The first n entries of the procFree list already form the list we hand out
+    proc_t* head = procFree_h;
+    proc_t* tail = head;
+    int i;
+    for (i = 1; i < n; i++) {
+        tail = tail->p_next;
+    }
+
+    // Cut the list after the n-th entry
+    procFree_h = tail->p_next;
+    procFreeCount -= n;
+    tail->p_next = (proc_t*)ENULL;
+    return head;
+}
+
+
+/*
+    Reinsert the element pointed to by p into the procFree list. It is pushed on the
+    front so the next allocProc reuses it while it is still warm in the cache.
 */
 void freeProc(proc_t* p)
 {
     resetProcess(p);
 
-    // procFree list is empty
-    if (procFree_h == (proc_t*)ENULL) {
-        procFree_h = p;
+    p->p_next = procFree_h;
+    procFree_h = p;
+    procFreeCount++;
+}
+
+
+/*
+    Reinsert every element of the list headed by p, linked through p_next and terminated
+    by ENULL, into the procFree list. The entries are reset in place and the whole list is
+    spliced onto the front of the procFree list at once.
+*/
+void freeProcList(proc_t* p)
+{
+    if (p == (proc_t*)ENULL) {
         return;
     }
 
-    // Insert the element into the procFree list
-    proc_t* proc = procFree_h;
-    while (proc->p_link[FREE_LIST].next != (proc_t*)ENULL) {
-        proc = proc->p_link[FREE_LIST].next;
+    // Reset each entry, keeping the list intact since resetProcess clears the links
+    proc_t* tail = p;
+    int n = 1;
+    while (TRUE) {
+        proc_t* next = tail->p_next;
+        resetProcess(tail);
+        if (next == (proc_t*)ENULL) {
+            break;
+        }
+        tail->p_next = next;
+        tail = next;
+        n++;
     }
 
-    proc->p_link[FREE_LIST].next = p;
+    // Splice the whole list onto the front of the procFree list
+    tail->p_next = procFree_h;
+    procFree_h = p;
+    procFreeCount += n;
 }
 
 
@@ -224,53 +388,150 @@ proc_t* headQueue(proc_link tp)
     if (tp.next == (proc_t*)ENULL) {
         return (proc_t*)ENULL;
     }
-    // tp->next is the tail proc_t & tp->next->p_link[idx] is the head proc_t
-    return tp.next->p_link[tp.index].next;
+    // linkPool[tp.index] is the tail's node & the node after it holds the head proc_t
+    return linkPool[linkPool[tp.index].next].owner;
 }
 
 
 /*
-    Initialize the procFree List to contain all the elements of the array procTable.
+    Return a pointer to the process table entry behind p in the queue whose tail is pointed to by tp.
+    If p is the tail or is not on that queue, return ENULL.
+*/
+proc_t* nextProc(proc_link* tp, proc_t* p)
+{
+    int proc_queue_idx = findQueueSlot(tp, p);
+    if (proc_queue_idx == ENULL || tp->next == p) {
+        return (proc_t*)ENULL;
+    }
+    return linkPool[linkPool[proc_queue_idx].next].owner;
+}
+
+
+/*
+    Initialize the procFree List to contain all the elements of the array procTable, and
+    put every link node of linkPool on its free list.
     Will be called only once during data structure initialization
 */
-void initProc() 
+void initProc()
 {
-    // The free list contains `proc_t` entries that are unused and available to be allocated for handling and managing new processes. 
+    // The free list contains `proc_t` entries that are unused and available to be allocated for handling and managing new processes.
     // It abstracts the process lifecycle by allowing dynamic allocation and reuse.
     procFree_h = &procTable[0];
+    procFreeCount = MAXPROC;
 
     // Traverse procTable
     int i;
-    for (i = 0; i < MAXPROC; i++) 
+    for (i = 0; i < MAXPROC; i++)
     {
-        // Set the current nodes next to the next process in the table
+        // Attach the entry's cold part, then set the current nodes next to the next process in the table
+#ifdef COLDINLINE
+        procTable[i].p_cold = &procTable[i].p_coldarea;
+#else
+        procTable[i].p_cold = &procColdTable[i];
+#endif
         resetProcess(&procTable[i]);
 
-        // Remove all processor states
-        procTable[i].mm_trap_old_state = (state_t*)ENULL;
-        procTable[i].mm_trap_new_state = (state_t*)ENULL;
-        procTable[i].sys_trap_old_state = (state_t*)ENULL;
-        procTable[i].sys_trap_new_state = (state_t*)ENULL;
-        procTable[i].prog_trap_old_state = (state_t*)ENULL;
-        procTable[i].prog_trap_new_state = (state_t*)ENULL;
+        if (i != MAXPROC - 1) {
+            procTable[i].p_next = &procTable[i + 1];
+        }
+    }
 
-        if (i != 19) {
-            procTable[i].p_link[FREE_LIST].next = &procTable[i + 1];
+    // The link node free list is chained through the next index
+    linkFree_h = 0;
+    for (i = 0; i < MAXLINKS; i++) {
+        linkPool[i].next = (i == MAXLINKS - 1) ? ENULL : i + 1;
+        linkPool[i].prev = ENULL;
+        linkPool[i].sibling = ENULL;
+        linkPool[i].owner = (proc_t*)ENULL;
+        linkPool[i].tp = (proc_link*)ENULL;
+        linkPool[i].units = 0;
+        linkPool[i].any = ENULL;
+    }
+}
+
+
+/*
+    Add the n process table entries starting at entries (memory set aside outside of procTable,
+    e.g. carved at boot) to the procFree list. cold holds the n matching cold parts (unused
+    when COLDINLINE keeps them inside the entries).
+*/
+void extendProc(proc_t* entries, proc_cold* cold, int n)
+{
+#ifdef COLDINLINE
+    (void)cold;
+#endif
+    int i;
+    for (i = 0; i < n; i++) {
+#ifdef COLDINLINE
+        entries[i].p_cold = &entries[i].p_coldarea;
+#else
+        entries[i].p_cold = &cold[i];
+#endif
+        freeProc(&entries[i]);
+    }
+}
+
+
+/*
+    Take a link node from the pool and add it to the nodes owned by the given process.
+    Returns the linkPool index of the node, or ENULL if the pool is empty. The pool is sized for
+    processes on one or two queues (MAXLINKS), so the callers pass running out back up.
+*/
+int allocLink(proc_t* p)
+{
+    int idx = linkFree_h;
+    if (idx == ENULL) {
+        return ENULL;
+    }
+
+    // Pop the node off the free list and push it on the front of the process's own nodes
+    linkFree_h = linkPool[idx].next;
+    linkPool[idx].owner = p;
+    linkPool[idx].sibling = p->p_link;
+    p->p_link = idx;
+    return idx;
+}
+
+
+/*
+    Return the link node at idx, owned by the given process, to the pool.
+*/
+void freeLink(proc_t* p, int idx)
+{
+    // Drop the node from the process's own nodes, which are at most SEMMAX long
+    if (p->p_link == idx) {
+        p->p_link = linkPool[idx].sibling;
+    }
+    else {
+        int i = p->p_link;
+        while (linkPool[i].sibling != idx) {
+            i = linkPool[i].sibling;
         }
+        linkPool[i].sibling = linkPool[idx].sibling;
     }
+
+    // Clear the node and push it on the free list
+    linkPool[idx].next = linkFree_h;
+    linkPool[idx].prev = ENULL;
+    linkPool[idx].sibling = ENULL;
+    linkPool[idx].owner = (proc_t*)ENULL;
+    linkPool[idx].tp = (proc_link*)ENULL;
+    linkPool[idx].units = 0;
+    linkPool[idx].any = ENULL;
+    linkFree_h = idx;
 }
 
 
 /*
-    Find an available queue slot (p_link index) for the given process that it is
-    not already part of. Returns the index of the free slot, or ENULL if the
-    process is already on the maximum allowable number of semaphore queues.
+    Return the linkPool index of the node through which the given process is on the queue
+    whose tail is pointed to by tp, or ENULL if the process is not on that queue.
 */
-int findAvailableQueueSlot(proc_t* p)
+int findQueueSlot(proc_link* tp, proc_t* p)
 {
+    // Only the nodes the process holds are visited, one per queue the process is on
     int i;
-    for (i = 0; i < SEMMAX; i++) {
-        if (p->p_link[i].next == (proc_t*)ENULL) {
+    for (i = p->p_link; i != ENULL; i = linkPool[i].sibling) {
+        if (linkPool[i].tp == tp) {
             return i;
         }
     }
@@ -278,38 +539,113 @@ int findAvailableQueueSlot(proc_t* p)
 }
 
 
+/*
+    Return the linkPool index of the node p goes in after on the queue whose tail is pointed to by tp,
+    when the tail is less urgent than p: the last node whose owner is at least as urgent as p, or the
+    tail if there is none (p is then the new head).
+*/
+int findPrioritySlot(proc_link* tp, proc_t* p)
+{
+    // Search back from the tail. Coming back around to it means no owner is as urgent as p
+    int tail_queue_idx = tp->index;
+    int after_queue_idx = tail_queue_idx;
+    do {
+        after_queue_idx = linkPool[after_queue_idx].prev;
+    } while (after_queue_idx != tail_queue_idx && linkPool[after_queue_idx].owner->p_priority < p->p_priority);
+    return after_queue_idx;
+}
+
+
+/*
+    Splice the process out of the queue whose tail is pointed to by tp, where idx is the
+    link node that holds the process on that queue. Its neighbours are reached through the
+    forward and back links, so this takes constant time. The node goes back to the pool.
+*/
+void unlinkProc(proc_link* tp, proc_t* p, int idx)
+{
+    link_t* link = &linkPool[idx];
+
+    // For single element process queue
+    if (link->next == idx) {
+        tp->next = (proc_t*)ENULL;
+        tp->index = ENULL;
+    }
+    else {
+        int prev_queue_idx = link->prev;
+        int next_queue_idx = link->next;
+
+        // Point the previous node at the next one and vice versa
+        linkPool[prev_queue_idx].next = next_queue_idx;
+        linkPool[next_queue_idx].prev = prev_queue_idx;
+
+        // proc before tail becomes new tail
+        if (tp->index == idx) {
+            tp->next = linkPool[prev_queue_idx].owner;
+            tp->index = prev_queue_idx;
+        }
+    }
+
+    // Release the process's link node for this queue and update fields
+    freeLink(p, idx);
+    p->qcount--;
+}
+
+
 /*
     Reset the given proc_t's fields and remove it from all associated process queues.
 */
 void resetProcess(proc_t* p)
 {
-    // Process does not belong to any queues
+    // Process does not belong to any queues or lists
     p->qcount = 0;
+    p->p_link = ENULL;
+    p->p_next = (proc_t*)ENULL;
+
+    // New processes start at the top MLFQ level, with the default time slice and stride tickets
+    p->p_level = 0;
+    p->p_quantum = QUANTUM;
+    p->p_tickets = TICKETS;
+    p->p_pass = 0;
+
+    // Default priority, not blocked on a mutex
+    p->p_priority = 0;
+    p->p_cold->base_priority = 0;
+    p->p_cold->base_tickets = TICKETS;
+    p->p_cold->base_level = ENULL;
+    p->p_cold->waiting_mutex = (int*)ENULL;
+    p->p_cold->wait_sem = (int*)ENULL;
+    p->p_cold->wait_start = 0;
 
     // The of processor time used by this process is 0
     p->total_processor_time = 0;
     p->last_start_time = 0;
 
     // Remove all progeny links
-    p->parent_proc = (proc_t*)ENULL;
-    p->sibling_proc = (proc_t*)ENULL;
-    p->children_proc = (proc_t*)ENULL;
-
-    // Remove any semaphores or proc links associated with this proc_t entry
-    int i;
-    for (i = 0; i < SEMMAX; i++) {
-        p->p_link[i].index = ENULL;
-        p->p_link[i].next = (proc_t*)ENULL;
-        p->semvec[i] = (int*)ENULL;
-    }
+    p->p_cold->parent_proc = (proc_t*)ENULL;
+    p->p_cold->sibling_proc = (proc_t*)ENULL;
+    p->p_cold->children_proc = (proc_t*)ENULL;
+
+    // A reused entry must not inherit the trap state vectors (SYS5) of its previous owner
+    p->p_cold->mm_trap_old_state = (state_t*)ENULL;
+    p->p_cold->mm_trap_new_state = (state_t*)ENULL;
+    p->p_cold->sys_trap_old_state = (state_t*)ENULL;
+    p->p_cold->sys_trap_new_state = (state_t*)ENULL;
+    p->p_cold->prog_trap_old_state = (state_t*)ENULL;
+    p->p_cold->prog_trap_new_state = (state_t*)ENULL;
+
+    // Not in a timed P
+    p->p_cold->wait_deadline = 0;
+    p->p_cold->timed_next = (proc_t*)ENULL;
 }
 
 
-// Panic function
-void panic(char* message) 
+// Panic function (host builds link the stand-in from host.c instead)
+#ifndef HOST
+void panic(char* message)
 {
     register char *i = msgbuf;
     while ((*i++ = *message++) != '\0')
         ;
          asm("	trap	#0");
 }
+#endif
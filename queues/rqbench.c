@@ -0,0 +1,77 @@
+/*********************************RQBENCH.C**********************************
+ *
+ *	Ready queue benchmark (host build, "make rqbench").
+ *
+ *	Every process is put on one queue in a scrambled order and the queue
+ *	is then rotated the way schedule() rotates the ready queue: the head
+ *	is removed, its start time is stamped and it is put back at the tail.
+ *	The mean cost of one rotation is reported for a few queue lengths.
+ *
+ *	The Makefile builds it twice: rqbench with the split process table
+ *	and rqbench_inline with the cold part kept inside each proc_t
+ *	(-DCOLDINLINE), so the two layouts can be compared.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../h/procq.e"
+
+#define	ROUNDS	4000000L
+#define	REPS	5
+
+proc_t *procp[MAXPROC];
+proc_link rq;
+
+
+double now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+
+double run(int n)
+{
+	int i, rep;
+	long r;
+	double start, t, best = 0;
+	proc_t *p;
+
+	for (rep = 0; rep < REPS; rep++) {
+		initProc();
+		for (i = 0; i < n; i++)
+			procp[i] = allocProc();
+		rq.next = (proc_t *) ENULL;
+		rq.index = ENULL;
+		for (i = 0; i < n; i++)
+			insertProc(&rq, procp[(int) ((i * 7919L) % n)]);
+
+		start = now();
+		for (r = 0; r < ROUNDS; r++) {
+			p = removeProc(&rq);
+			p->last_start_time = r;
+			insertProc(&rq, p);
+		}
+		t = (now() - start) / ROUNDS;
+		if (best == 0 || t < best)
+			best = t;
+	}
+	return (best);
+}
+
+
+int main()
+{
+	int n;
+
+	printf("proc_t %d bytes, link_t %d bytes\n", (int) sizeof(proc_t),
+	    (int) sizeof(link_t));
+	for (n = 64; n <= MAXPROC; n *= 4)
+		printf("%6d processes  %8.1f ns/rotation\n", n, run(n));
+	return (0);
+}
@@ -0,0 +1,199 @@
+/*********************************SCALEBENCH.C*******************************
+ *
+ *	Microbenchmark for the queue and ASL modules (host build,
+ *	"make scalebench").
+ *
+ *	The process and semaphore tables are grown past their static sizes
+ *	with extendProc/extendSemd, the same way the nucleus grows them with
+ *	entries carved below MEMSTART at boot. For each table size every
+ *	entry is put through the queue and ASL operations. Each operation is
+ *	timed on its own and the number of operations, the mean, and the
+ *	p50/p99 latencies are reported in nanoseconds (the cost of reading
+ *	the clock is measured once and taken off every sample).
+ *
+ *	usage: scalebench [-r reps] [entries ...]
+ *	The default sizes are 20, 200, 2000, ... and the largest the build
+ *	allows (the static tables plus BENCHN in the Makefile).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../h/procq.e"
+#include "../h/asl.e"
+
+#define	MAXN	(MAXPROC + EXTRAPROC < MAXSEMD + EXTRASEMD ? \
+		 MAXPROC + EXTRAPROC : MAXSEMD + EXTRASEMD)
+
+proc_t extraproc[EXTRAPROC];	/* stands in for the entries carved at boot */
+proc_cold extracold[EXTRAPROC];
+semd_t extrasemd[EXTRASEMD];
+proc_t *procp[MAXN];
+int sem[MAXN];
+int order[MAXN];		/* scrambled visiting order */
+proc_link ql;
+
+enum { INSERTPROC, OUTPROC, REMOVEPROC, INSERTBLOCKED_NEW, INSERTBLOCKED,
+	HEADBLOCKED, OUTBLOCKED, REMOVEBLOCKED, NOPS };
+char *opname[NOPS] = { "insertProc", "outProc", "removeProc",
+	"insertBlocked (new)", "insertBlocked", "headBlocked", "outBlocked",
+	"removeBlocked" };
+
+long *sample[NOPS];		/* per operation latencies of one size, in ns */
+long nsample[NOPS];
+long clockcost;			/* ns spent reading the clock, taken off each sample */
+
+/* time one operation and keep its latency */
+#define	TIMED(op, stmt) { \
+	long t0 = now(); \
+	stmt; \
+	record(op, now() - t0); \
+}
+
+
+long now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+
+void record(int op, long t)
+{
+	t -= clockcost;
+	sample[op][nsample[op]++] = t < 0 ? 0 : t;
+}
+
+
+/* Cheapest of many back to back clock reads */
+void calibrate()
+{
+	long t0, t;
+	int i;
+
+	clockcost = 0;
+	for (i = 0; i < 100000; i++) {
+		t0 = now();
+		t = now() - t0;
+		if (i == 0 || t < clockcost)
+			clockcost = t;
+	}
+}
+
+
+int cmplong(const void *a, const void *b)
+{
+	long x = *(const long *) a, y = *(const long *) b;
+
+	return (x < y ? -1 : x > y);
+}
+
+
+void report(int n)
+{
+	int op;
+	long i, c;
+	double sum;
+
+	for (op = 0; op < NOPS; op++) {
+		c = nsample[op];
+		qsort(sample[op], c, sizeof(long), cmplong);
+		for (sum = 0, i = 0; i < c; i++)
+			sum += sample[op][i];
+		if (op == 0)
+			printf("%6d", n);
+		else
+			printf("%6s", "");
+		printf("  %-20s %9ld %9.1f %7ld %7ld\n", opname[op], c,
+		    sum / c, sample[op][c / 2], sample[op][c * 99 / 100]);
+	}
+}
+
+
+void run(int n, int reps)
+{
+	int i, rep, op;
+
+	for (i = 0; i < n; i++)
+		order[i] = (int) ((i * 7919L) % n);
+	for (op = 0; op < NOPS; op++)
+		nsample[op] = 0;
+
+	for (rep = 0; rep < reps; rep++) {
+		initProc();
+		initSemd();
+		extendProc(extraproc, extracold, n > MAXPROC ? n - MAXPROC : 0);
+		extendSemd(extrasemd, n > MAXSEMD ? n - MAXSEMD : 0);
+		for (i = 0; i < n; i++)
+			procp[i] = allocProc();
+		ql.next = (proc_t *) ENULL;
+		ql.index = ENULL;
+
+		/* one queue holding every process */
+		for (i = 0; i < n; i++)
+			TIMED(INSERTPROC, insertProc(&ql, procp[i]));
+		for (i = 0; i < n; i++)
+			TIMED(OUTPROC, outProc(&ql, procp[order[i]]));
+		for (i = 0; i < n; i++)
+			insertProc(&ql, procp[i]);
+		for (i = 0; i < n; i++)
+			TIMED(REMOVEPROC, removeProc(&ql));
+
+		/* every process blocked on its own semaphore */
+		for (i = 0; i < n; i++)
+			TIMED(INSERTBLOCKED_NEW,
+			    insertBlocked(&sem[order[i]], procp[order[i]]));
+		for (i = 0; i < n; i++)
+			TIMED(HEADBLOCKED, headBlocked(&sem[order[i]]));
+		for (i = 0; i < n; i++)
+			TIMED(OUTBLOCKED, outBlocked(procp[order[i]]));
+
+		/* every process blocked on one shared semaphore */
+		for (i = 0; i < n; i++)
+			TIMED(INSERTBLOCKED, insertBlocked(&sem[0], procp[i]));
+		for (i = 0; i < n; i++)
+			TIMED(REMOVEBLOCKED, removeBlocked(&sem[0]));
+	}
+	report(n);
+}
+
+
+int main(int argc, char **argv)
+{
+	int i, n, op, reps = 5, sizes = 0;
+
+	if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+		reps = atoi(argv[2]);
+		argc -= 2;
+		argv += 2;
+	}
+	for (op = 0; op < NOPS; op++)
+		sample[op] = (long *) malloc(sizeof(long) * MAXN * (reps > 0 ? reps : 1));
+
+	calibrate();
+	printf("clock read %ld ns, %d reps per size\n", clockcost, reps);
+	printf("%6s  %-20s %9s %9s %7s %7s\n", "size", "operation", "ops",
+	    "mean ns", "p50", "p99");
+
+	for (i = 1; i < argc; i++) {
+		n = atoi(argv[i]);
+		if (n < 1 || n > MAXN) {
+			fprintf(stderr, "scalebench: size %d not in 1..%d\n", n, MAXN);
+			return (1);
+		}
+		run(n, reps);
+		sizes++;
+	}
+	if (sizes == 0) {
+		for (n = 20; n * 10 <= MAXN; n *= 10)
+			run(n, reps);
+		run(MAXN, reps);
+	}
+	return (0);
+}
@@ -0,0 +1,651 @@
+/*********************************STRESS.C***********************************
+ *
+ *	Randomized stress test for the queue and ASL modules (host build,
+ *	"make stress").
+ *
+ *	Millions of random insertProc, removeProc, outProc, headQueue
+ *	(walking the rest of the queue with nextProc), insertBlockedN,
+ *	insertBlockedAny, removeBlocked, removeBlockedAll, releaseBlocked,
+ *	outBlocked, outBlockedRelease, outBlockedAny, headBlocked (with
+ *	countBlocked), headASL, setSemaphorePolicy and requeueBlocked calls
+ *	(with processes of a few different priorities) are made on a set of process queues
+ *	and semaphores. Every result is checked against a plain reference
+ *	model (an array per queue, and per process the queues it is on in
+ *	the order of its link nodes, which is the order wait-any releases
+ *	cascade in), and the qcount of every process, the semaphore values,
+ *	the wait-any that fired, the link pool (running out of it included,
+ *	for process and semaphore queues) and the ASL (in address order
+ *	after orderedASL) are checked as well. The first mismatch is
+ *	reported and the run stops with exit status 1.
+ *
+ *	Each call is also timed, and a log2 latency histogram is printed for
+ *	every operation, so a path that grows with the queue or table size
+ *	shows up in the tail buckets.
+ *
+ *	usage: stress [-n ops] [-p procs] [-q queues] [-s sems] [-r seed]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../h/const.h"
+#include "../h/types.h"
+
+#include "../h/procq.e"
+#include "../h/asl.e"
+
+#define	MAXQ	64		/* process queues */
+#define	MAXS	(4 * MAXSEMD)	/* semaphores, more than there are descriptors */
+#define	NBUCKET	16		/* latency buckets: < 16ns, < 32ns, ... */
+#define	CHECKEVERY 1024		/* ops between full invariant checks */
+
+enum { INSERTPROC, REMOVEPROC, OUTPROC, HEADQUEUE, INSERTBLOCKED,
+	INSERTBLOCKEDANY, REMOVEBLOCKED, REMOVEBLOCKEDALL, RELEASEBLOCKED,
+	OUTBLOCKED, OUTBLOCKEDRELEASE, OUTBLOCKEDANY, HEADBLOCKED, HEADASL,
+	SETPOLICY, REQUEUEBLOCKED, NOPS };
+char *opname[NOPS] = { "insertProc", "removeProc", "outProc", "headQueue",
+	"insertBlockedN", "insertBlockedAny", "removeBlocked",
+	"removeBlockedAll", "releaseBlocked", "outBlocked",
+	"outBlockedRelease", "outBlockedAny", "headBlocked", "headASL",
+	"setSemaphorePolicy", "requeueBlocked" };
+
+extern int linkFree_h;
+extern link_t linkPool[];
+extern semd_t *semd_h;
+extern int semLinkCount;
+
+proc_t *procp[MAXPROC];
+proc_link queue[MAXQ];
+int sem[MAXS];
+
+/* reference model: the members of every queue in order, and per process counts */
+int *model[MAXQ + MAXS];
+int *munits[MAXQ + MAXS];	/* units each member of a semaphore queue waits for */
+int *many[MAXQ + MAXS];		/* wait-any index of each member, or -1 */
+int mlen[MAXQ + MAXS];
+int mcount[MAXPROC];		/* queues each process is on */
+int mchain[MAXPROC][SEMMAX];	/* those queues, newest first like the link nodes */
+int mfired[MAXPROC];		/* index of the wait-any P that fired last, or -1 */
+int mvalue[MAXS];		/* expected semaphore values */
+int mpolicy[MAXS];		/* SEMFIFO or SEMPRIORITY */
+int mpolicies;			/* semaphores with SEMPRIORITY */
+int mactive;			/* semaphores with a nonempty queue */
+int mlinks;			/* link nodes in use */
+int msemlinks;			/* those holding processes on semaphore queues */
+
+long hist[NOPS][NBUCKET];
+long count[NOPS];
+long worst[NOPS];
+long opno;
+
+int nprocs = MAXPROC, nqueues = 8, nsems = MAXS;
+
+
+long now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+
+void record(int op, long t)
+{
+	int b = 0;
+
+	while (b < NBUCKET - 1 && t >= (16L << b))
+		b++;
+	hist[op][b]++;
+	count[op]++;
+	if (t > worst[op])
+		worst[op] = t;
+}
+
+
+void fail(int op, char *what)
+{
+	printf("stress: op %ld (%s): %s\n", opno, opname[op], what);
+	exit(1);
+}
+
+
+/* Position of process p on model queue q, or -1 */
+int mfind(int q, int p)
+{
+	int i;
+
+	for (i = 0; i < mlen[q]; i++)
+		if (model[q][i] == p)
+			return (i);
+	return (-1);
+}
+
+
+/* Put p at the tail of model queue q, or behind the last member as urgent with SEMPRIORITY */
+void madd(int q, int p, int units, int any)
+{
+	int i = mlen[q];
+
+	if (q >= MAXQ && mlen[q] == 0)
+		mactive++;
+	if (q >= MAXQ && mpolicy[q - MAXQ] == SEMPRIORITY)
+		while (i > 0 && procp[model[q][i - 1]]->p_priority < procp[p]->p_priority)
+			i--;
+	memmove(&model[q][i + 1], &model[q][i], (mlen[q] - i) * sizeof(int));
+	memmove(&munits[q][i + 1], &munits[q][i], (mlen[q] - i) * sizeof(int));
+	memmove(&many[q][i + 1], &many[q][i], (mlen[q] - i) * sizeof(int));
+	munits[q][i] = units;
+	many[q][i] = any;
+	model[q][i] = p;
+	mlen[q]++;
+	memmove(&mchain[p][1], &mchain[p][0], mcount[p] * sizeof(int));
+	mchain[p][0] = q;
+	mcount[p]++;
+	mlinks++;
+	msemlinks += q >= MAXQ;
+}
+
+
+/* Take the member at position i off model queue q */
+void mremove(int q, int i)
+{
+	int p = model[q][i], k;
+
+	memmove(&model[q][i], &model[q][i + 1], (mlen[q] - i - 1) * sizeof(int));
+	memmove(&munits[q][i], &munits[q][i + 1], (mlen[q] - i - 1) * sizeof(int));
+	memmove(&many[q][i], &many[q][i + 1], (mlen[q] - i - 1) * sizeof(int));
+	mlen[q]--;
+	if (q >= MAXQ && mlen[q] == 0)
+		mactive--;
+	for (k = 0; mchain[p][k] != q; k++)
+		;
+	memmove(&mchain[p][k], &mchain[p][k + 1], (mcount[p] - k - 1) * sizeof(int));
+	mcount[p]--;
+	mlinks--;
+	msemlinks -= q >= MAXQ;
+}
+
+
+/* Take p off its model semaphores (only its wait-any ones if anyonly), giving the units back */
+int mdetach(int p, int anyonly, int *detached)
+{
+	int chain[SEMMAX], n = mcount[p], k, i, s, d = 0;
+
+	memcpy(chain, mchain[p], n * sizeof(int));
+	for (k = 0; k < n; k++) {
+		if (chain[k] < MAXQ)
+			continue;
+		s = chain[k] - MAXQ;
+		i = mfind(chain[k], p);
+		if (anyonly && many[chain[k]][i] < 0)
+			continue;
+		mvalue[s] += munits[chain[k]][i];
+		mremove(chain[k], i);
+		detached[d++] = s;
+	}
+	return (d);
+}
+
+
+void msettle(int *detached, int n, int q);
+
+/* Take the head off model semaphore s, firing its wait-any; onto queue q unless q is -1 */
+int mreleasehead(int s, int q)
+{
+	int p = model[MAXQ + s][0], any = many[MAXQ + s][0], n = 0;
+	int detached[SEMMAX];
+
+	mremove(MAXQ + s, 0);
+	if (any >= 0) {
+		mfired[p] = any;
+		n = mdetach(p, 1, detached);
+	}
+	if (q >= 0 && mcount[p] == 0)
+		madd(q, p, 0, -1);
+	msettle(detached, n, q);
+	return (p);
+}
+
+
+/* Release the heads of model semaphore s whose units are there, onto the end of model queue q */
+int mrelease(int s, int q)
+{
+	int i, units, n = 0;
+
+	for (;;) {
+		for (i = 0, units = 0; i < mlen[MAXQ + s]; i++)
+			units += munits[MAXQ + s][i];
+		if (mlen[MAXQ + s] == 0 || munits[MAXQ + s][0] > mvalue[s] + units)
+			break;
+		mreleasehead(s, q);
+		n++;
+	}
+	return (n);
+}
+
+
+void msettle(int *detached, int n, int q)
+{
+	int i;
+
+	for (i = 0; q >= 0 && i < n; i++)
+		mrelease(detached[i], q);
+}
+
+
+/* Check process queue q against the model: in order up to from, as a set after it */
+void mcompare(int op, int q, int from)
+{
+	int i, k, idx, seen[MAXPROC];
+
+	if (mlen[q] == 0) {
+		if (queue[q].next != (proc_t *) ENULL)
+			fail(op, "queue should be empty");
+		return;
+	}
+	memset(seen, 0, sizeof(seen));
+	idx = linkPool[queue[q].index].next;
+	for (i = 0; i < mlen[q]; i++) {
+		for (k = 0; k < nprocs && procp[k] != linkPool[idx].owner; k++)
+			;
+		if (k == nprocs || (i < from && k != model[q][i]))
+			fail(op, "queue order does not match the model");
+		seen[k]++;
+		idx = linkPool[idx].next;
+	}
+	if (idx != linkPool[queue[q].index].next)
+		fail(op, "queue is longer than the model");
+	for (i = from; i < mlen[q]; i++)
+		if (seen[model[q][i]] != 1)
+			fail(op, "queue members do not match the model");
+
+	/* adopt the real order of the appended members */
+	idx = linkPool[queue[q].index].next;
+	for (i = 0; i < mlen[q]; i++) {
+		for (k = 0; procp[k] != linkPool[idx].owner; k++)
+			;
+		model[q][i] = k;
+		idx = linkPool[idx].next;
+	}
+}
+
+
+proc_t *mhead(int q)
+{
+	return (mlen[q] ? procp[model[q][0]] : (proc_t *) ENULL);
+}
+
+
+/* Walk the queue of semaphore s with nextProc and check it against the model */
+void checksem(int op, int s)
+{
+	semd_t *d;
+	proc_t *r;
+	int i;
+
+	for (d = semd_h; d != (semd_t *) ENULL && d->s_semAdd != &sem[s]; d = d->s_next)
+		;
+	if (d == (semd_t *) ENULL)
+		return;
+	r = headQueue(d->s_link);
+	for (i = 0; r != (proc_t *) ENULL; i++) {
+		if (i >= mlen[MAXQ + s] || r != procp[model[MAXQ + s][i]])
+			fail(op, "semaphore queue order does not match the model");
+		r = nextProc(&d->s_link, r);
+	}
+	if (i != mlen[MAXQ + s])
+		fail(op, "semaphore queue is shorter than the model");
+}
+
+
+/* Whether process p can go on one more queue without hitting SEMMAX */
+int canjoin(int p)
+{
+	return (mcount[p] < SEMMAX);
+}
+
+
+void checkall()
+{
+	int p, n = 0, i;
+	semd_t *d;
+
+	for (p = 0; p < nprocs; p++)
+		if (procp[p]->qcount != mcount[p])
+			fail(HEADQUEUE, "qcount does not match the model");
+	for (i = linkFree_h; i != ENULL; i = linkPool[i].next)
+		n++;
+	if (n != MAXLINKS - mlinks)
+		fail(HEADQUEUE, "link nodes lost or duplicated");
+	if (semLinkCount != msemlinks)
+		fail(INSERTBLOCKED, "semaphore link nodes do not match the model");
+	for (i = 0; i < nsems; i++)
+		if (sem[i] != mvalue[i])
+			fail(OUTBLOCKED, "semaphore value does not match the model");
+	for (i = 0; i < nsems; i++)
+		if (countBlocked(&sem[i]) != mlen[MAXQ + i])
+			fail(HEADBLOCKED, "countBlocked does not match the model");
+	for (p = 0; p < nprocs; p++)
+		if (procp[p]->p_cold->p_s.s_r[3] != (mfired[p] < 0 ? ENULL : mfired[p]))
+			fail(INSERTBLOCKEDANY, "fired wait-any does not match the model");
+	n = 0;
+	for (d = semd_h; d != (semd_t *) ENULL; d = d->s_next) {
+		if (d->s_next != (semd_t *) ENULL && d->s_next->s_prev != d)
+			fail(HEADASL, "ASL back links are broken");
+		n++;
+	}
+	if (n != mactive)
+		fail(HEADASL, "ASL length does not match the model");
+	n = 0;
+	for (d = orderedASL(); d != (semd_t *) ENULL; d = d->s_next) {
+		if (d->s_next != (semd_t *) ENULL && (d->s_next->s_semAdd <= d->s_semAdd || d->s_next->s_prev != d))
+			fail(HEADASL, "orderedASL is not in address order");
+		n++;
+	}
+	if (n != mactive || (semd_h != (semd_t *) ENULL && semd_h->s_prev != (semd_t *) ENULL))
+		fail(HEADASL, "orderedASL lost descriptors");
+}
+
+
+void step()
+{
+	int op = rand() % NOPS, p = rand() % nprocs;
+	int q = rand() % nqueues, s = rand() % nsems, i, k, units, any;
+	int detached[SEMMAX];
+	proc_t *r;
+	long t0;
+
+	switch (op) {
+	case INSERTPROC:
+		if (mfind(q, p) >= 0 || !canjoin(p))
+			return;
+		t0 = now();
+		i = insertProc(&queue[q], procp[p]);
+		record(op, now() - t0);
+		if (i != (mlinks == MAXLINKS))
+			fail(op, "wrong result");
+		if (i)
+			return;
+		madd(q, p, 0, -1);
+		break;
+	case REMOVEPROC:
+		t0 = now();
+		r = removeProc(&queue[q]);
+		record(op, now() - t0);
+		if (r != mhead(q))
+			fail(op, "removed the wrong process");
+		if (mlen[q])
+			mremove(q, 0);
+		break;
+	case OUTPROC:
+		i = mfind(q, p);
+		t0 = now();
+		r = outProc(&queue[q], procp[p]);
+		record(op, now() - t0);
+		if (r != (i >= 0 ? procp[p] : (proc_t *) ENULL))
+			fail(op, "wrong result");
+		if (i >= 0)
+			mremove(q, i);
+		break;
+	case HEADQUEUE:
+		t0 = now();
+		r = headQueue(queue[q]);
+		record(op, now() - t0);
+		if (r != mhead(q))
+			fail(op, "wrong head");
+		for (i = 1; r != (proc_t *) ENULL; i++) {
+			r = nextProc(&queue[q], r);
+			if (r != (i < mlen[q] ? procp[model[q][i]] : (proc_t *) ENULL))
+				fail(op, "nextProc does not match the model");
+		}
+		break;
+	case INSERTBLOCKED:
+	case INSERTBLOCKEDANY:
+		/* a wait-any puts p on up to three semaphores, tagged with their index */
+		for (k = 0; k < (op == INSERTBLOCKED ? 1 : 1 + rand() % 3); k++) {
+			s = rand() % nsems;
+			if (mfind(MAXQ + s, p) >= 0 || !canjoin(p))
+				return;
+			units = 1 + rand() % 3;
+			t0 = now();
+			if (op == INSERTBLOCKED)
+				i = insertBlockedN(&sem[s], procp[p], units);
+			else
+				i = insertBlockedAny(&sem[s], procp[p], units, k);
+			record(op, now() - t0);
+			if (i != ((mlen[MAXQ + s] == 0 && mactive == MAXSEMD) ||
+			    msemlinks == SEMLINKS || mlinks == MAXLINKS))
+				fail(op, "wrong result");
+			if (i)
+				return;
+			madd(MAXQ + s, p, units, op == INSERTBLOCKED ? -1 : k);
+		}
+		break;
+	case REMOVEBLOCKED:
+		t0 = now();
+		r = removeBlocked(&sem[s]);
+		record(op, now() - t0);
+		if (r != mhead(MAXQ + s))
+			fail(op, "removed the wrong process");
+		if (mlen[MAXQ + s])
+			mreleasehead(s, -1);
+		break;
+	case RELEASEBLOCKED:
+		units = rand() % 4;
+		sem[s] += units;
+		mvalue[s] += units;
+		t0 = now();
+		i = releaseBlocked(&sem[s], &queue[q]);
+		record(op, now() - t0);
+		if (i != mrelease(s, q))
+			fail(op, "wrong number of processes released");
+		mcompare(op, q, mlen[q]);
+		break;
+	case REMOVEBLOCKEDALL:
+		for (i = 0, units = 0, k = 0; i < mlen[MAXQ + s]; i++) {
+			units += munits[MAXQ + s][i];
+			k += many[MAXQ + s][i] >= 0;
+		}
+		t0 = now();
+		i = removeBlockedAll(&sem[s], &queue[q]);
+		record(op, now() - t0);
+		if (i != units)
+			fail(op, "wrong number of units removed");
+		if (k) {
+			/* with a wait-any on the queue, each process is released in turn */
+			while (mlen[MAXQ + s])
+				mreleasehead(s, q);
+		} else {
+			/* otherwise the queue is spliced: nodes of processes on it alone move to q */
+			for (i = 0; i < mlen[MAXQ + s]; i++) {
+				p = model[MAXQ + s][i];
+				if (mcount[p] == 1) {
+					model[q][mlen[q]++] = p;
+					mchain[p][0] = q;
+				} else {
+					for (k = 0; mchain[p][k] != MAXQ + s; k++)
+						;
+					memmove(&mchain[p][k], &mchain[p][k + 1],
+					    (mcount[p] - k - 1) * sizeof(int));
+					mcount[p]--;
+					mlinks--;
+				}
+			}
+			if (mlen[MAXQ + s])
+				mactive--;
+			msemlinks -= mlen[MAXQ + s];
+			mlen[MAXQ + s] = 0;
+		}
+		mcompare(op, q, mlen[q]);
+		break;
+	case OUTBLOCKED:
+	case OUTBLOCKEDRELEASE:
+	case OUTBLOCKEDANY:
+		t0 = now();
+		if (op == OUTBLOCKED)
+			r = outBlocked(procp[p]);
+		else if (op == OUTBLOCKEDRELEASE)
+			r = outBlockedRelease(procp[p], &queue[q]);
+		else
+			r = outBlockedAny(procp[p], &queue[q]);
+		record(op, now() - t0);
+		k = mdetach(p, op == OUTBLOCKEDANY, detached);
+		msettle(detached, k, op == OUTBLOCKED ? -1 : q);
+		if (r != (k ? procp[p] : (proc_t *) ENULL))
+			fail(op, "wrong result");
+		mcompare(op, q, mlen[q]);
+		break;
+	case HEADBLOCKED:
+		t0 = now();
+		r = headBlocked(&sem[s]);
+		record(op, now() - t0);
+		if (r != mhead(MAXQ + s))
+			fail(op, "wrong head");
+		if (countBlocked(&sem[s]) != mlen[MAXQ + s])
+			fail(op, "countBlocked does not match the model");
+		checksem(op, s);
+		break;
+	case HEADASL:
+		t0 = now();
+		i = headASL();
+		record(op, now() - t0);
+		if (i != (mactive > 0))
+			fail(op, "wrong result");
+		break;
+	case SETPOLICY:
+		/* mostly FIFO semaphores, and priorities shuffled now and then */
+		k = rand() % 4 == 0 ? SEMPRIORITY : SEMFIFO;
+		procp[p]->p_priority = rand() % 4;
+		t0 = now();
+		i = setSemaphorePolicy(&sem[s], k);
+		record(op, now() - t0);
+		if (i != (k == SEMPRIORITY && mpolicy[s] == SEMFIFO &&
+		    mpolicies == SEMPOLICIES))
+			fail(op, "wrong result");
+		if (i)
+			break;
+		mpolicies += (k == SEMPRIORITY) - (mpolicy[s] == SEMPRIORITY);
+		mpolicy[s] = k;
+		break;
+	case REQUEUEBLOCKED:
+		/* p inherits a priority and moves up the semaphore's queue, keeping its link node */
+		procp[p]->p_priority += rand() % 2;
+		t0 = now();
+		i = requeueBlocked(&sem[s], procp[p]);
+		record(op, now() - t0);
+		k = mfind(MAXQ + s, p);
+		if (i != (k < 0))
+			fail(op, "wrong result");
+		if (i)
+			break;
+		q = MAXQ + s;
+		units = munits[q][k];
+		any = many[q][k];
+		memmove(&model[q][k], &model[q][k + 1], (mlen[q] - k - 1) * sizeof(int));
+		memmove(&munits[q][k], &munits[q][k + 1], (mlen[q] - k - 1) * sizeof(int));
+		memmove(&many[q][k], &many[q][k + 1], (mlen[q] - k - 1) * sizeof(int));
+		for (k = mlen[q] - 1; k > 0 && procp[model[q][k - 1]]->p_priority < procp[p]->p_priority; k--)
+			;
+		memmove(&model[q][k + 1], &model[q][k], (mlen[q] - 1 - k) * sizeof(int));
+		memmove(&munits[q][k + 1], &munits[q][k], (mlen[q] - 1 - k) * sizeof(int));
+		memmove(&many[q][k + 1], &many[q][k], (mlen[q] - 1 - k) * sizeof(int));
+		model[q][k] = p;
+		munits[q][k] = units;
+		many[q][k] = any;
+		checksem(op, s);
+		break;
+	}
+}
+
+
+/* Latency at which the cumulative count of op reaches the given fraction, as a bucket bound */
+long percentile(int op, double f)
+{
+	long c = 0;
+	int b;
+
+	for (b = 0; b < NBUCKET - 1; b++) {
+		c += hist[op][b];
+		if (c >= f * count[op])
+			break;
+	}
+	return (16L << b);
+}
+
+
+void report()
+{
+	int op, b;
+
+	printf("%-18s %9s %7s %7s %9s  histogram (ns: <16 <32 <64 ... >=256k)\n",
+	    "operation", "ops", "p50<", "p99<", "max");
+	for (op = 0; op < NOPS; op++) {
+		printf("%-18s %9ld %7ld %7ld %9ld ", opname[op], count[op],
+		    percentile(op, 0.5), percentile(op, 0.99), worst[op]);
+		for (b = 0; b < NBUCKET; b++)
+			printf(" %ld", hist[op][b]);
+		printf("\n");
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	long nops = 2000000;
+	int i, seed = 1;
+
+	for (i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "-n") == 0)
+			nops = atol(argv[i + 1]);
+		else if (strcmp(argv[i], "-p") == 0)
+			nprocs = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "-q") == 0)
+			nqueues = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "-s") == 0)
+			nsems = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "-r") == 0)
+			seed = atoi(argv[i + 1]);
+		else
+			break;
+	}
+	if (i < argc || nprocs < 1 || nprocs > MAXPROC || nqueues < 1 ||
+	    nqueues > MAXQ || nsems < 1 || nsems > MAXS) {
+		fprintf(stderr, "usage: stress [-n ops] [-p procs (<= %d)] "
+		    "[-q queues (<= %d)] [-s sems (<= %d)] [-r seed]\n",
+		    MAXPROC, MAXQ, MAXS);
+		return (2);
+	}
+	srand(seed);
+
+	initProc();
+	initSemd();
+	for (i = 0; i < nprocs; i++)
+		procp[i] = allocProc();
+	for (i = 0; i < MAXQ; i++) {
+		queue[i].next = (proc_t *) ENULL;
+		queue[i].index = ENULL;
+	}
+	for (i = 0; i < MAXQ + MAXS; i++) {
+		model[i] = (int *) malloc(sizeof(int) * nprocs);
+		munits[i] = (int *) malloc(sizeof(int) * nprocs);
+		many[i] = (int *) malloc(sizeof(int) * nprocs);
+	}
+	for (i = 0; i < nprocs; i++) {
+		procp[i]->p_cold->p_s.s_r[3] = ENULL;
+		mfired[i] = -1;
+	}
+
+	printf("stress: %ld ops, %d procs, %d queues, %d sems, seed %d\n",
+	    nops, nprocs, nqueues, nsems, seed);
+	for (opno = 0; opno < nops; opno++) {
+		step();
+		if (opno % CHECKEVERY == 0)
+			checkall();
+	}
+	checkall();
+	report();
+	printf("stress: ok\n");
+	return (0);
+}
@@ -73,6 +73,9 @@ extern int wake_up_cron_sem;
 // Global counter for active T-processes
 extern int active_t_processes;
 
+// Virtual semaphores (slsyscall2.c)
+extern void vsemrelease(int term_idx);
+
 
 /*
     Requests that the invoking T-process be suspended until a line of input has been
@@ -306,6 +309,9 @@ void terminate()
     // Free the pages from Segment 1 (User/Private data) 
     putframe(term_idx);
 
+    // Free the virtual semaphores no other T-process uses
+    vsemrelease(term_idx);
+
     // Kill Process
     DO_TERMINATEPROC();
 }
@@ -109,6 +109,9 @@ void writetoterminal();
 void delay();
 void gettimeofday();
 void terminate();
+void virtualv();
+void virtualp();
+void vseminit();
 
 #define START_SUPPORT_TEXT ((int)startt1 / PAGESIZE)
 #define END_SUPPORT_TEXT ((int)etext / PAGESIZE)
@@ -388,6 +391,9 @@ void p1()
         CRON_TABLE[o].wakeUpTime = -1;	// Set Process wakeup time to -1 to signal no delay requested
     }
 
+    // Initialize the (empty) virtual semaphore table
+    vseminit();
+
     // Create p1a process state
     state_t p1aState;
     p1aState.s_sr.ps_s = 1;			// Supervisor/Privilege mode on
@@ -670,6 +676,12 @@ void static slsyshandler()
         case (10):
             writetoterminal();
             break;
+        case (11):
+            virtualv();
+            break;
+        case (12):
+            virtualp();
+            break;
         case (13):
             delay();
             break;
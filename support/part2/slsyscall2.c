@@ -1,13 +1,296 @@
-virtualv()
+#include "../../h/const.h"
+#include "../../h/types.h"
+#include "../../h/vpop.h"
+#include "../part1/h/tconst.h"
+
+
+// Kernel Routines
+#define DO_SEMOP			SYS3
+
+// Global CPU registers
+register int r2 asm("%d2");
+register int r3 asm("%d3");
+register int r4 asm("%d4");
+
+#define KERNEL_PAGES 256
+
+// Start of the segment after the shared Segment 2
+#define SEG3 0x180000
+
+typedef struct runnable_process_t {
+    sd_t user_mode_sd_table[32];
+    sd_t kernel_mode_sd_table[32];
+
+    pd_t user_mode_pd_table[32];
+    pd_t kernel_mode_pd_table[KERNEL_PAGES];
+
+    state_t SUPPORT_SYS_TRAP_OLD_STATE;
+    state_t SUPPORT_SYS_TRAP_NEW_STATE;
+    state_t SUPPORT_PROG_TRAP_OLD_STATE;
+    state_t SUPPORT_PROG_TRAP_NEW_STATE;
+    state_t SUPPORT_MM_TRAP_OLD_STATE;
+    state_t SUPPORT_MM_TRAP_NEW_STATE;
+    char io_buffer[512];
+
+} runnable_process_t;
+
+extern runnable_process_t terminal_processes[MAXTPROC];
+
+
+/*
+    Virtual Semaphores (SYS11/SYS12):
+    - A virtual semaphore is an int in Segment 2, named by its virtual address. T-processes share Segment 2,
+      so the same address is the same semaphore for all of them.
+    - The first virtual P or V on an address gives it an entry in vsemTable, found again through a hash
+      index keyed by the virtual address. The entry starts with the value the T-process left in the int.
+    - From then on the value lives in the entry's v_count, which is a plain semaphore in support memory:
+      the virtual P or V is a single SYS3 on it. An uncontended one returns straight away (it never involves
+      a support daemon or any other lock), and a P that must wait blocks on v_count's queue in the nucleus.
+      The int in Segment 2 is refreshed after every operation so the T-processes can still read it.
+    - Each entry records the T-processes that use it (v_users, one bit each). A T-process's first P or V on
+      an entry sets its bit, and its terminate() clears its bits: an entry that no T-process uses any more has
+      no waiters either, and it goes back on the free list (its value is still in the int in Segment 2).
+    - Entries are added and freed, and bits are set or cleared, only under vsem_table_sem. An entry is filled
+      in before the hash index points to it, and it is only freed once its users are gone. So a lookup needs
+      no lock: a T-process only takes the fast path on an entry that has its own bit, which nobody else clears.
+      A lookup that races with a change to the index just misses, and takes the locked path.
+*/
+
+// Virtual semaphores that can be in use at once, and the size of their hash index (a power of two, at least twice VSEMMAX)
+#define VSEMMAX 32
+#define VSEMHASH 64
+
+#if MAXTPROC > 32
+#error "v_users has one bit per T-process"
+#endif
+
+typedef struct vsem_t {
+    int* v_addr;		// Virtual address of the semaphore in Segment 2, ENULL while the entry is free
+    int v_count;		// The semaphore proper, P'd and V'd by the nucleus
+    int v_users;		// T-processes that have used it, bit term_idx each
+    struct vsem_t* v_next;	// Next entry on the free list
+} vsem_t;
+
+vsem_t vsemTable[VSEMMAX];
+vsem_t* vsemHash[VSEMHASH];
+vsem_t* vsemFree_h = (vsem_t*)ENULL;	// Entries freed by terminate(), used before new ones
+int vsemCount = 0;				// Entries of vsemTable handed out so far
+
+// Semaphore for exclusive access to adding and freeing entries of vsemTable
+int vsem_table_sem = 1;
+
+// Header declarations of local routines
+vsem_t* findvsem(int* virtualAddr);
+vsem_t* allocvsem(int* virtualAddr);
+void freevsem(vsem_t* vsem);
+void static locktable(int op);
+void static vsemop(int op);
+
+
+/*
+    Empty the virtual semaphore table (called once from p1()).
+*/
+void vseminit()
 {
-  HALT();
+    int i;
+    for (i = 0; i < VSEMHASH; i++) {
+        vsemHash[i] = (vsem_t*)ENULL;
+    }
+    vsemFree_h = (vsem_t*)ENULL;
+    vsemCount = 0;
 }
 
-virtualp()
+
+/*
+    Drop the T-process term_idx from the users of every virtual semaphore, and free the entries it was
+    the last user of (called from terminate()).
+*/
+void vsemrelease(int term_idx)
 {
-  HALT();
+    locktable(LOCK);
+
+    int i;
+    for (i = 0; i < vsemCount; i++) {
+        vsem_t* vsem = &vsemTable[i];
+        if (vsem->v_addr != (int*)ENULL && (vsem->v_users & (1 << term_idx)) != 0) {
+            vsem->v_users &= ~(1 << term_idx);
+            if (vsem->v_users == 0) {
+                freevsem(vsem);
+            }
+        }
+    }
+
+    locktable(UNLOCK);
 }
 
+
+/*
+    Performs a V operation on the virtual semaphore whose virtual address is in D4 at the time of the call.
+    The address must be in Segment 2, otherwise the T-process is terminated.
+*/
+void virtualv()
+{
+    vsemop(UNLOCK);
+}
+
+
+/*
+    Performs a P operation on the virtual semaphore whose virtual address is in D4 at the time of the call.
+    The address must be in Segment 2, otherwise the T-process is terminated.
+*/
+void virtualp()
+{
+    vsemop(LOCK);
+}
+
+
+/*
+    Return the entry of the virtual semaphore at virtualAddr, or ENULL if it has none yet.
+*/
+vsem_t* findvsem(int* virtualAddr)
+{
+    int bucket = ((unsigned)virtualAddr >> 2) & (VSEMHASH - 1);
+
+    while (vsemHash[bucket] != (vsem_t*)ENULL) {
+        if (vsemHash[bucket]->v_addr == virtualAddr) {
+            return vsemHash[bucket];
+        }
+        bucket = (bucket + 1) & (VSEMHASH - 1);
+    }
+    return (vsem_t*)ENULL;
+}
+
+
+/*
+    Give the virtual semaphore at virtualAddr an entry, starting with the value in the int there, and
+    add it to the hash index. Return ENULL if every entry is in use. Called with vsem_table_sem held.
+*/
+vsem_t* allocvsem(int* virtualAddr)
+{
+    vsem_t* vsem = vsemFree_h;
+    if (vsem != (vsem_t*)ENULL) {
+        vsemFree_h = vsem->v_next;
+    }
+    else if (vsemCount < VSEMMAX) {
+        vsem = &vsemTable[vsemCount++];
+    }
+    else {
+        return (vsem_t*)ENULL;
+    }
+    vsem->v_addr = virtualAddr;
+    vsem->v_count = *virtualAddr;
+    vsem->v_users = 0;
+
+    // Publish the entry only once it is filled in
+    int bucket = ((unsigned)virtualAddr >> 2) & (VSEMHASH - 1);
+    while (vsemHash[bucket] != (vsem_t*)ENULL) {
+        bucket = (bucket + 1) & (VSEMHASH - 1);
+    }
+    vsemHash[bucket] = vsem;
+    return vsem;
+}
+
+
+/*
+    Take the entry, which no T-process uses any more, out of the hash index and put it on the free list.
+    The entries further along its probe run are shifted back into the hole when their home bucket allows
+    it, as in the ASL's hash index. Called with vsem_table_sem held.
+*/
+void freevsem(vsem_t* vsem)
+{
+    int hole = ((unsigned)vsem->v_addr >> 2) & (VSEMHASH - 1);
+    while (vsemHash[hole] != vsem) {
+        hole = (hole + 1) & (VSEMHASH - 1);
+    }
+    vsemHash[hole] = (vsem_t*)ENULL;
+
+    int bucket = (hole + 1) & (VSEMHASH - 1);
+    while (vsemHash[bucket] != (vsem_t*)ENULL) {
+        int home = ((unsigned)vsemHash[bucket]->v_addr >> 2) & (VSEMHASH - 1);
+        if (((hole - home) & (VSEMHASH - 1)) < ((bucket - home) & (VSEMHASH - 1))) {
+            vsemHash[hole] = vsemHash[bucket];
+            vsemHash[bucket] = (vsem_t*)ENULL;
+            hole = bucket;
+        }
+        bucket = (bucket + 1) & (VSEMHASH - 1);
+    }
+
+    vsem->v_addr = (int*)ENULL;
+    vsem->v_next = vsemFree_h;
+    vsemFree_h = vsem;
+}
+
+
+/*
+    P (op LOCK) or V (op UNLOCK) vsem_table_sem.
+*/
+void static locktable(int op)
+{
+    vpop tableOperation;
+    tableOperation.op = op;
+    tableOperation.sem = &vsem_table_sem;
+    r3 = 1;
+    r4 = (int)&tableOperation;
+    DO_SEMOP();
+}
+
+
+/*
+    Apply op (LOCK or UNLOCK) to the virtual semaphore named by D4 of the calling T-process.
+*/
+void static vsemop(int op)
+{
+    // Get the Terminal Process state and index in the loaded New State Area
+    state_t terminal_sys_new_state;
+    STST(&terminal_sys_new_state);
+
+    // Get the Terminal Process index from the CPU state
+    int term_idx = terminal_sys_new_state.s_r[4];
+    runnable_process_t* terminalProcess = &terminal_processes[term_idx];
+
+    // Virtual semaphores live in the shared Segment 2, a P or V on any other address (e.g. a private one) is an error
+    int* virtualAddr = (int*)terminalProcess->SUPPORT_SYS_TRAP_OLD_STATE.s_r[4];
+    if ((int)virtualAddr < SEG2 || (int)virtualAddr >= SEG3 || ((int)virtualAddr & 1) != 0) {
+        DO_TTERMINATE();
+    }
+
+    int user = 1 << term_idx;
+    vsem_t* vsem = findvsem(virtualAddr);
+
+    // First use of this address by this T-process: join the entry's users (adding the entry if it has none),
+    // looking it up again once we hold the table in case another T-process just added or freed it
+    if (vsem == (vsem_t*)ENULL || (vsem->v_users & user) == 0) {
+        locktable(LOCK);
+
+        vsem = findvsem(virtualAddr);
+        if (vsem == (vsem_t*)ENULL) {
+            vsem = allocvsem(virtualAddr);
+        }
+        if (vsem != (vsem_t*)ENULL) {
+            vsem->v_users |= user;
+        }
+
+        locktable(UNLOCK);
+
+        // No room for another virtual semaphore
+        if (vsem == (vsem_t*)ENULL) {
+            DO_TTERMINATE();
+        }
+    }
+
+    // The P or V itself is one semop, which only blocks the T-process if the semaphore has no units
+    vpop semOperation;
+    semOperation.op = op;
+    semOperation.sem = &vsem->v_count;
+    r3 = 1;
+    r4 = (int)&semOperation;
+    DO_SEMOP();
+
+    // Let the T-processes see the current value
+    *virtualAddr = vsem->v_count;
+}
+
+
 diskput()
 {
   HALT();